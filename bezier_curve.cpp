@@ -5,6 +5,8 @@
 #include <QtMath>
 #include "bezier_curve.h"
 #include "mainwindow.h"
+#include "fixed_point_retimer.h"
+#include "retime_cache.h"
 
 /*
  * Bezier_Curve is a window which the Bezier Curve will be drawn
@@ -22,10 +24,14 @@ Bezier_Curve::Bezier_Curve(QWidget *parent)
     QPoint c2= QPoint(1884,37);
     QPoint p1= QPoint(1884,37);
 
+    /*
+     * Floating point (QPainterPath) or integer only (Fixed_Point_Retimer) calculation of the degrees and
+     * skip/extend index list. See calculate_bezier_degrees_fixed
+     */
+    this->fixed_point = false;
+
     //Setup the QPainterPath as a linear line
-    this->bezier_path.clear();
-    this->bezier_path.moveTo(p0);
-    this->bezier_path.cubicTo(c1,c2, p1);
+    set_bezier_points({p0, c1, c2, p1});
 
     //Setup the BezierCurve Window size with some padding
     int width = p1.x() - p0.x() + 100;
@@ -47,7 +53,10 @@ void Bezier_Curve::paintEvent(QPaintEvent *event)
     painter.drawPath(bezier_path);
 }
 
-void Bezier_Curve::deploy_bezier_curve(QList<Frame *>frame_new_list)
+/*
+ * The Bezier Curve applied by "Deploy Bezier Curve". Select the curve by compiling in the selection.
+ */
+Bezier_Points Bezier_Curve::selected_bezier_points()
 {
     //Ease-In Bezier Curve
     QPoint p0= QPoint(37,110);
@@ -65,10 +74,27 @@ void Bezier_Curve::deploy_bezier_curve(QList<Frame *>frame_new_list)
     p1= QPoint(1884,37);
     */
 
-    //Setup the Bezier Curve
+    return {p0, c1, c2, p1};
+}
+
+//Setup the Bezier Curve. The Bezier Curve Window is updated on the next paint
+void Bezier_Curve::set_bezier_points(const Bezier_Points &points)
+{
+    this->points = points;
     this->bezier_path.clear();
-    this->bezier_path.moveTo(p0);
-    this->bezier_path.cubicTo(c1,c2, p1);
+    this->bezier_path.moveTo(points.p0);
+    this->bezier_path.cubicTo(points.c1, points.c2, points.p1);
+    this->update();
+}
+
+/*
+ * Deploy the selected Bezier Curve on frame_new_list, on the calling thread.
+ * MainWindow deploys on a Deploy_Worker instead so that the GUI does not freeze
+ */
+void Bezier_Curve::deploy_bezier_curve(QList<Frame *>frame_new_list)
+{
+    //Setup the Bezier Curve
+    set_bezier_points(selected_bezier_points());
 
     //Ensure Bezier Curve Window draws the latest Bezier Curve
     this->repaint();
@@ -80,30 +106,66 @@ void Bezier_Curve::deploy_bezier_curve(QList<Frame *>frame_new_list)
      *      "accelerate to frame N" (+N)
      *      "slow down N frames" (-N)
      *      "maintain sequence" (0)
+     * The result for the same Bezier points and number of Frames is taken from Retime_Cache when available.
      */
-    this->calculate_bezier_degrees(false, frame_new_list);
+    compute_retiming(this->points, this->fixed_point, this->begin_angle, frame_new_list.length(),
+                     &this->degrees_list, &this->skip_extend_index_list);
 
     //Shape Animation according to this->degrees_skip_index_list
     reinterpolate_frames(frame_new_list);
 
 }
 
-void debug_frames(QList<Frame *>frame_list, int dst_index)
+/*
+ * Calculate degrees_list and skip_extend_index_list for points and frame_count Frames, taking the result from
+ * Retime_Cache when available and storing it otherwise. begin_angle is that of the linear line (see constructor).
+ */
+void Bezier_Curve::compute_retiming(const Bezier_Points &points, bool fixed_point, qreal begin_angle, int frame_count,
+                                    QList<qreal> *degrees_list, QList<float> *skip_extend_index_list)
+{
+    QString cache_key = Retime_Cache::key(points, frame_count, fixed_point);
+    if (Retime_Cache::instance()->load(cache_key, degrees_list, skip_extend_index_list)){
+        qDebug() << "Retime Cache hit" << cache_key;
+        return;
+    }
+
+    if (fixed_point)
+        compute_bezier_degrees_fixed(points, false, frame_count, &begin_angle, degrees_list, skip_extend_index_list);
+    else
+        compute_bezier_degrees(points, false, frame_count, &begin_angle, degrees_list, skip_extend_index_list);
+
+    Retime_Cache::instance()->store(cache_key, *degrees_list, *skip_extend_index_list);
+}
+
+/*
+ * Content map (original Frame shown at each index) of the Bezier Curve points over frame_count Frames - the same
+ * retiming as "Deploy Bezier Curve", without touching any Frame
+ */
+QVector<int> Bezier_Curve::compute_content_map(const Bezier_Points &points, bool fixed_point, qreal begin_angle, int frame_count)
+{
+    QList<qreal>degrees_list;
+    QList<float>skip_extend_index_list;
+    compute_retiming(points, fixed_point, begin_angle, frame_count, &degrees_list, &skip_extend_index_list);
+    return content_map_from_timeline(reinterpolate_timeline(skip_extend_index_list, frame_count));
+}
+
+void debug_frames(const Retime_Timeline &timeline, int dst_index)
 {
-    Frame *frame;
+    if (!DEBUG_RETIMING)
+        return;
+
     QString temp_str;
 
     qDebug() << " ";
     qDebug() << "***************Debug Frame dst_index=" << dst_index;
 
     for (int i=0; i< dst_index/2; i++) {
-        frame = frame_list.at(i);
-        temp_str.append(QString::number(frame->src_index));
+        temp_str.append(QString::number(timeline.src_index.at(i)));
         temp_str.append( "/");
-        temp_str.append(QString::number(frame->index));
+        temp_str.append(QString::number(i));
         temp_str.append( "/");
-        temp_str.append(QString::number(frame->delta));
-        if (frame->overwritten)
+        temp_str.append(QString::number(timeline.delta.at(i)));
+        if (timeline.overwritten.at(i))
            temp_str.append("* #");
         else
            temp_str.append(" #");
@@ -111,14 +173,13 @@ void debug_frames(QList<Frame *>frame_list, int dst_index)
     qDebug() << temp_str;
 
     temp_str.clear();
-    for (int i=dst_index/2; i<= dst_index; i++) {
-        frame = frame_list.at(i);
-        temp_str.append(QString::number(frame->src_index));
+    for (int i=dst_index/2; i<= dst_index && i < timeline.length(); i++) {
+        temp_str.append(QString::number(timeline.src_index.at(i)));
         temp_str.append( "/");
-        temp_str.append(QString::number(frame->index));
+        temp_str.append(QString::number(i));
         temp_str.append( "/");
-        temp_str.append(QString::number(frame->delta));
-        if (frame->overwritten)
+        temp_str.append(QString::number(timeline.delta.at(i)));
+        if (timeline.overwritten.at(i))
            temp_str.append("* #");
         else
            temp_str.append(" #");
@@ -139,18 +200,35 @@ void debug_frames(QList<Frame *>frame_list, int dst_index)
  */
 void Bezier_Curve::calculate_bezier_degrees(bool initialize, QList<Frame *>frame_list)
 {
-    this->degrees_list.clear();
-    this->skip_extend_index_list.clear();
+    if (this->fixed_point){
+        calculate_bezier_degrees_fixed(initialize, frame_list);
+        return;
+    }
+
+    compute_bezier_degrees(this->points, initialize, frame_list.length(), &this->begin_angle,
+                           &this->degrees_list, &this->skip_extend_index_list);
+}
+
+/*
+ * See calculate_bezier_degrees. If initialize, *begin_angle is set from the points (which should be a linear line),
+ * otherwise *begin_angle is used to calculate the skip/extend index list for frame_count Frames.
+ */
+void Bezier_Curve::compute_bezier_degrees(const Bezier_Points &points, bool initialize, int frame_count, qreal *begin_angle,
+                                          QList<qreal> *degrees_list, QList<float> *skip_extend_index_list)
+{
+    degrees_list->clear();
+    skip_extend_index_list->clear();
 
     /*
      * Setup degree_list which is tangent at each point from 1% to 100% along QPainterPath
      */
-    QPainterPath *painter_path;
-    painter_path = &this->bezier_path;
+    QPainterPath painter_path;
+    painter_path.moveTo(points.p0);
+    painter_path.cubicTo(points.c1, points.c2, points.p1);
 
     for (qreal percent=0.0; percent <= 1.0; percent=percent+0.01){
         //Get the slope (tangent) at specific percentage
-        qreal slope_temp = painter_path->slopeAtPercent(percent);
+        qreal slope_temp = painter_path.slopeAtPercent(percent);
 
         int res = std::fpclassify(slope_temp);
         switch (res){
@@ -164,18 +242,19 @@ void Bezier_Curve::calculate_bezier_degrees(bool initialize, QList<Frame *>frame
 
         //From slope, get the angle (in radians) and convert to degrees
         qreal angle = qAtan(slope_temp);
-        qreal degree = angle * 180/3.142;
-        qDebug() << "degree=" << degree << " radian=" << angle << " Slope=" << slope_temp << " percent=" << percent;
+        qreal degree = qRadiansToDegrees(angle);
+        if (DEBUG_RETIMING)
+            qDebug() << "degree=" << degree << " radian=" << angle << " Slope=" << slope_temp << " percent=" << percent;
 
         //Store in degrees list for further processing
-        this->degrees_list.append(degree);
+        degrees_list->append(degree);
 
         /*
          * If Initalize, store the degree to begin_angle. Note all points along the path is the same degree
          * since the line between the 2 end points is straight, linear line  when setup initially.
          */
         if (initialize)
-            this->begin_angle = abs(degree);
+            *begin_angle = abs(degree);
 
     }
 
@@ -186,14 +265,14 @@ void Bezier_Curve::calculate_bezier_degrees(bool initialize, QList<Frame *>frame
      * (0,0) on bottom left. This makes the slope positive by such reference. Note that we reserve negative value to a different meaning
      */
     QList<qreal>temp_list;
-    for (int i=0; i < this->degrees_list.length(); i++){
-        if (this->degrees_list.at(i) > 0){
+    for (int i=0; i < degrees_list->length(); i++){
+        if (degrees_list->at(i) > 0){
             qDebug() << "Unexpected positive";
-            temp_list.append(this->begin_angle);
+            temp_list.append(*begin_angle);
         } else
-            temp_list.append(abs(this->degrees_list.at(i)));
+            temp_list.append(abs(degrees_list->at(i)));
     }
-    this->degrees_list = temp_list;
+    *degrees_list = temp_list;
 
     //Dont need to go further if initialize
     if (initialize)
@@ -204,56 +283,59 @@ void Bezier_Curve::calculate_bezier_degrees(bool initialize, QList<Frame *>frame
      * "accelerate" (+) or "slow down" (-) or maintain sequence (0)
      */
     int prev_adjusted_index_topath = 0;
-    for (int i=0; i < frame_list.length(); i++){
+    for (int i=0; i < frame_count; i++){
         /*
          * All lists so far are based on 0% - 100% along the QPainterPath between the two end points.
          * This is not the same scale as the number of Frame instances.
          * We will thus build the skip_delta_list based on the latter scale.
          */
-        float scale_ratio = (float) 100/this->degrees_list.length();
+        float scale_ratio = (float) 100/degrees_list->length();
         float index_temp = i * scale_ratio;
         int adjusted_index_topath = round(index_temp);
 
-        //Make sure adjusted_index_topath does not exceed this->degrees_list
-        if (adjusted_index_topath > (this->degrees_list.length()-1))
-            adjusted_index_topath = this->degrees_list.length()-1;
+        //Make sure adjusted_index_topath does not exceed degrees_list
+        if (adjusted_index_topath > (degrees_list->length()-1))
+            adjusted_index_topath = degrees_list->length()-1;
 
         float delta;
         if (i== 0)
-            delta = (this->degrees_list.at(adjusted_index_topath) - this->begin_angle)/this->begin_angle;
+            delta = (degrees_list->at(adjusted_index_topath) - *begin_angle)/ *begin_angle;
         else
-            delta = (this->degrees_list.at(adjusted_index_topath) - this->degrees_list.at(prev_adjusted_index_topath))/this->begin_angle;
+            delta = (degrees_list->at(adjusted_index_topath) - degrees_list->at(prev_adjusted_index_topath))/ *begin_angle;
 
         int skip_index = round(delta);
-        this->skip_extend_index_list.append(skip_index);
+        skip_extend_index_list->append(skip_index);
         prev_adjusted_index_topath = adjusted_index_topath;
 
     }
-    qDebug() << "Degrees List=" << this->degrees_list;
-    qDebug() << "Degrees Skip Index=" << this->skip_extend_index_list;
-
+    if (DEBUG_RETIMING){
+        qDebug() << "Degrees List=" << *degrees_list;
+        qDebug() << "Degrees Skip Index=" << *skip_extend_index_list;
+    }
 }
 
-void Bezier_Curve::extend_src_delta_times(int dst_index, int delta, QList<Frame *>frame_list)
+/*
+ * Extend the contents of the previous slot of the timeline abs(delta) times, starting at dst_index
+ */
+void Bezier_Curve::extend_src_delta_times(int dst_index, int delta, Retime_Timeline &timeline)
 {
-    Frame *prv_frame, *dst_frame, *src_frame;
-    if (dst_index > 0){
-        prv_frame = frame_list.at(dst_index-1);
-        if (prv_frame && prv_frame->overwritten){
-           if ((prv_frame->src_index+1) < frame_list.length())
-               copy_src_to_dst_frame(prv_frame->src_index+1, dst_index, delta, frame_list);
+    if (dst_index > 0 && dst_index < timeline.length()){
+        int prv_src_index = timeline.src_index.at(dst_index-1);
+        if (timeline.overwritten.at(dst_index-1)){
+           if ((prv_src_index+1) < timeline.length())
+               copy_src_to_dst_frame(prv_src_index+1, dst_index, delta, timeline);
            else
-               copy_src_to_dst_frame(prv_frame->src_index, dst_index, delta, frame_list);
+               copy_src_to_dst_frame(prv_src_index, dst_index, delta, timeline);
 
-           //debug_frames(frame_list, dst_index);
+           //debug_frames(timeline, dst_index);
         }
         dst_index++;
 
         if ((abs(delta)-1) >=1) {
-           prv_frame = frame_list.at(dst_index-1);
-           for (int i=0; i < (abs(delta)-1); i++){
-               copy_src_to_dst_frame(prv_frame->src_index+1, dst_index, delta, frame_list);
-               //debug_frames(frame_list, dst_index);
+           int src_index = timeline.src_index.at(dst_index-1) + 1;
+           for (int i=0; i < (abs(delta)-1) && dst_index < timeline.length(); i++){
+               copy_src_to_dst_frame(qMin(src_index, timeline.length()-1), dst_index, delta, timeline);
+               //debug_frames(timeline, dst_index);
                dst_index++;
            }
         }
@@ -261,27 +343,39 @@ void Bezier_Curve::extend_src_delta_times(int dst_index, int delta, QList<Frame
 
 }
 
-void Bezier_Curve::copy_src_to_dst_frame(int src_index, int dst_index, int delta, QList<Frame *>frame_list)
+/*
+ * Copy the contents of slot src_index to slot dst_index. No image is copied - the timeline only records which original
+ * Frame's image is shown (content_index), see apply_timeline
+ */
+void Bezier_Curve::copy_src_to_dst_frame(int src_index, int dst_index, int delta, Retime_Timeline &timeline)
 {
-    Frame *src_frame, *dst_frame;
-    src_frame = frame_list.at(src_index);
-    dst_frame = frame_list.at(dst_index);
-
-    *dst_frame->image = src_frame->image->copy();
-    dst_frame->src_index = src_index;
-    dst_frame->overwritten = true;
-    dst_frame->delta = delta;
+    timeline.set_slot(dst_index, src_index, timeline.content_index.at(src_index), delta, true);
 }
 
 /*
  * Reinterpolate the Frames in frame_list to follow the bezier curve shape
  */
 void Bezier_Curve::reinterpolate_frames(QList<Frame *>frame_list)
+{
+    this->timeline = reinterpolate_timeline(this->skip_extend_index_list, frame_list.length());
+
+    //Contents are copied from the Frames as they are now. QImage copies are shared until modified
+    QVector<QImage>images;
+    for (int i=0; i < timeline.length(); i++)
+        images.append(*frame_list.at(timeline.content_index.at(i))->image);
+
+    apply_timeline(this->timeline, images, frame_list);
+}
+
+/*
+ * Build the timeline of frame_count slots following the bezier curve shape, starting from the identity timeline
+ */
+Retime_Timeline Bezier_Curve::reinterpolate_timeline(const QList<float> &skip_extend_index_list, int frame_count)
 {
     int delta;
     int dst_index = 0;
     int src_index = 0;
-    Frame *prv_frame;
+    Retime_Timeline timeline = identity_timeline(frame_count);
 
     /*
      * skip_extend_index_list contains the delta by which the frames
@@ -296,40 +390,95 @@ void Bezier_Curve::reinterpolate_frames(QList<Frame *>frame_list)
      *  0  : Maintain sequence
      *
      */
-    qDebug() << this->skip_extend_index_list;
+    if (DEBUG_RETIMING)
+        qDebug() << skip_extend_index_list;
 
-    for (int i=0; i < this->skip_extend_index_list.length(); i++){
+    for (int i=0; i < skip_extend_index_list.length(); i++){
 
-        if (dst_index >= frame_list.length())
-            return;
+        if (dst_index >= timeline.length())
+            break;
 
-        delta = this->skip_extend_index_list.at(i);
+        delta = skip_extend_index_list.at(i);
 
         if (delta > 0){
 
             if (dst_index >0){
-                prv_frame = frame_list.at(dst_index-1);
-                if (prv_frame->overwritten){
-                    extend_src_delta_times(dst_index, 1, frame_list);
-                    debug_frames(frame_list, dst_index);
-                    prv_frame = frame_list.at(dst_index);
-                    src_index = prv_frame->src_index + delta;
+                if (timeline.overwritten.at(dst_index-1)){
+                    extend_src_delta_times(dst_index, 1, timeline);
+                    debug_frames(timeline, dst_index);
+                    src_index = timeline.src_index.at(dst_index) + delta;
                     dst_index++;
                 }
             } else
                 src_index = delta + dst_index;
 
-            copy_src_to_dst_frame(src_index, dst_index, delta, frame_list);
-            debug_frames(frame_list, dst_index);
+            if (dst_index >= timeline.length())
+                break;
+            copy_src_to_dst_frame(qMin(src_index, timeline.length()-1), dst_index, delta, timeline);
+            debug_frames(timeline, dst_index);
             dst_index++;
         } else if (delta < 0){
-            extend_src_delta_times(dst_index, delta, frame_list);
+            extend_src_delta_times(dst_index, delta, timeline);
             dst_index = dst_index + abs(delta);
-            debug_frames(frame_list, dst_index-1);
+            debug_frames(timeline, dst_index-1);
         } else {
-            extend_src_delta_times(dst_index, 1, frame_list);
-            debug_frames(frame_list, dst_index);
+            extend_src_delta_times(dst_index, 1, timeline);
+            debug_frames(timeline, dst_index);
             dst_index++;
         }
     }
+
+    return timeline;
+}
+
+/*
+ * Show timeline on the Frames of frame_list. images holds the image for each slot of the timeline.
+ * The Frames only display - the timeline itself is kept by the caller (eg MainWindow::new_timeline)
+ */
+void Bezier_Curve::apply_timeline(const Retime_Timeline &timeline, const QVector<QImage> &images, QList<Frame *>frame_list)
+{
+    for (int i=0; i < timeline.length() && i < frame_list.length(); i++){
+        Frame *frame = frame_list.at(i);
+        *frame->image = images.at(i);
+        frame->update_memory_accounting();
+    }
+}
+
+/*
+ * Integer only equivalent of calculate_bezier_degrees (see Fixed_Point_Retimer). There is no floating point in the
+ * calculation, so degrees_list and skip_extend_index_list are bit-exact across compilers and platforms.
+ * The results are converted to this->degrees_list and this->skip_extend_index_list so the rest of Bezier_Curve is unchanged.
+ */
+void Bezier_Curve::calculate_bezier_degrees_fixed(bool initialize, QList<Frame *>frame_list)
+{
+    compute_bezier_degrees_fixed(this->points, initialize, frame_list.length(), &this->begin_angle,
+                                 &this->degrees_list, &this->skip_extend_index_list);
+}
+
+//See calculate_bezier_degrees_fixed and compute_bezier_degrees
+void Bezier_Curve::compute_bezier_degrees_fixed(const Bezier_Points &points, bool initialize, int frame_count, qreal *begin_angle,
+                                                QList<qreal> *degrees_list, QList<float> *skip_extend_index_list)
+{
+    degrees_list->clear();
+    skip_extend_index_list->clear();
+
+    Fixed_Point_Retimer retimer(points);
+    retimer.calculate_degrees();
+
+    for (int i=0; i < retimer.degrees_list.length(); i++)
+        degrees_list->append(Fixed_Point_Retimer::to_qreal(retimer.degrees_list.at(i)));
+
+    if (initialize){
+        *begin_angle = Fixed_Point_Retimer::to_qreal(retimer.begin_angle);
+        return;
+    }
+
+    QList<int>skip_list = retimer.calculate_skip_extend_index_list(frame_count);
+    for (int i=0; i < skip_list.length(); i++)
+        skip_extend_index_list->append(skip_list.at(i));
+
+    if (DEBUG_RETIMING){
+        qDebug() << "Fixed Point Degrees List=" << *degrees_list;
+        qDebug() << "Fixed Point Degrees Skip Index=" << *skip_extend_index_list;
+    }
 }
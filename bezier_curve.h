@@ -3,7 +3,14 @@
 
 #include <QObject>
 #include <QWidget>
+#include <QImage>
+#include <QVector>
 #include "frame.h"
+#include "bezier_points.h"
+#include "retime_timeline.h"
+
+//Set to true to log every degree calculated and every step of the reinterpolation
+#define DEBUG_RETIMING false
 
 class Bezier_Curve : public QWidget
 {
@@ -11,15 +18,35 @@ class Bezier_Curve : public QWidget
 public:
     explicit Bezier_Curve(QWidget *parent = nullptr);
     QPainterPath bezier_path;
+    Bezier_Points points;
     qreal begin_angle;
+    bool fixed_point;
     QList<qreal>degrees_list;
     QList<float>skip_extend_index_list;
+    Retime_Timeline timeline;
 
+    static Bezier_Points selected_bezier_points();
+    void set_bezier_points(const Bezier_Points &points);
     void deploy_bezier_curve(QList<Frame *>frame_new_list);
     void calculate_bezier_degrees(bool initialize, QList<Frame *>frame_list);
+    void calculate_bezier_degrees_fixed(bool initialize, QList<Frame *>frame_list);
     void reinterpolate_frames(QList<Frame *>frame_new_list);
-    void copy_src_to_dst_frame(int src_index, int dst_index, int delta, QList<Frame *>frame_list);
-    void extend_src_delta_times(int src_index, int delta, QList<Frame *>frame_list);
+
+    /*
+     * The calculations themselves only depend on their parameters, so they can be run on any thread
+     * (see Deploy_Worker)
+     */
+    static void compute_bezier_degrees(const Bezier_Points &points, bool initialize, int frame_count, qreal *begin_angle,
+                                       QList<qreal> *degrees_list, QList<float> *skip_extend_index_list);
+    static void compute_bezier_degrees_fixed(const Bezier_Points &points, bool initialize, int frame_count, qreal *begin_angle,
+                                             QList<qreal> *degrees_list, QList<float> *skip_extend_index_list);
+    static void compute_retiming(const Bezier_Points &points, bool fixed_point, qreal begin_angle, int frame_count,
+                                 QList<qreal> *degrees_list, QList<float> *skip_extend_index_list);
+    static QVector<int> compute_content_map(const Bezier_Points &points, bool fixed_point, qreal begin_angle, int frame_count);
+    static Retime_Timeline reinterpolate_timeline(const QList<float> &skip_extend_index_list, int frame_count);
+    static void copy_src_to_dst_frame(int src_index, int dst_index, int delta, Retime_Timeline &timeline);
+    static void extend_src_delta_times(int dst_index, int delta, Retime_Timeline &timeline);
+    static void apply_timeline(const Retime_Timeline &timeline, const QVector<QImage> &images, QList<Frame *>frame_list);
 
 signals:
 
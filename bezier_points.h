@@ -0,0 +1,21 @@
+#ifndef BEZIER_POINTS_H
+#define BEZIER_POINTS_H
+
+#include <QPoint>
+
+/*
+ * The 4 points of a cubic Bezier Curve in Bezier Curve Window coordinates ((0,0) on the top Left).
+ *   p0 - begin end point
+ *   c1 - first control point
+ *   c2 - second control point
+ *   p1 - end end point
+ */
+struct Bezier_Points
+{
+    QPoint p0;
+    QPoint c1;
+    QPoint c2;
+    QPoint p1;
+};
+
+#endif // BEZIER_POINTS_H
@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <QtConcurrent>
+#include <QFile>
+#include <QJsonArray>
+#include <QtMath>
+#include "curve_extraction.h"
+#include "simd_kernels.h"
+#include "frame.h"
+
+QString Extracted_Curve::easing_name() const
+{
+    return QString("cubic-bezier(%1, %2, %3, %4)").arg(easing.x1, 0, 'f', 3).arg(easing.y1, 0, 'f', 3)
+                                                  .arg(easing.x2, 0, 'f', 3).arg(easing.y2, 0, 'f', 3);
+}
+
+QJsonObject Extracted_Curve::to_json() const
+{
+    QJsonArray content_array;
+    for (int i=0; i < content_map.length(); i++)
+        content_array.append(content_map.at(i));
+
+    return QJsonObject{{"content_map", content_array}, {"match_error", match_error},
+                       {"easing", easing_name()}, {"easing_error", easing_error},
+                       {"keyframes", keyframes.to_json()}, {"keyframes_error", keyframes_error}};
+}
+
+//The .png files of the sequence in directory (see Frame::frame_filename), from index 0 up to the first missing
+QVector<QImage> Curve_Extraction::read_sequence(const QString &directory)
+{
+    QVector<QImage>images;
+    while (QFile::exists(Frame::frame_filename(directory, images.length()))){
+        QImage image(Frame::frame_filename(directory, images.length()));
+        if (image.isNull())
+            break;
+        images.append(image);
+    }
+    return images;
+}
+
+struct Match_Row
+{
+    int reference;
+    QVector<qreal> costs;
+};
+
+/*
+ * Source frame matching each reference frame. Among all matchings which never go back in time, the one with the least
+ * total image difference is returned - so a frame of a hold or of a still part of the animation that matches several
+ * source frames equally well is not matched out of order. *match_error is the mean difference of the matches.
+ */
+QVector<int> Curve_Extraction::match_frames(const QVector<QImage> &source, const QVector<QImage> &reference,
+                                            qreal *match_error)
+{
+    QVector<int>content_map;
+    *match_error = 0.0;
+    if (source.isEmpty() || reference.isEmpty() || source.first().isNull())
+        return content_map;
+
+    //Both sequences at one small size and format, so that any 2 frames can be compared
+    QSize match_size = source.first().size().scaled(EXTRACTION_MATCH_WIDTH, EXTRACTION_MATCH_WIDTH * 4, Qt::KeepAspectRatio);
+    QVector<QImage>small_source = source;
+    QVector<QImage>small_reference = reference;
+    auto shrink = [match_size](QImage &image) {
+        image = image.scaled(match_size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                     .convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    };
+    QtConcurrent::blockingMap(small_source, shrink);
+    QtConcurrent::blockingMap(small_reference, shrink);
+
+    QVector<Match_Row>rows(reference.length());
+    for (int i=0; i < rows.length(); i++)
+        rows[i].reference = i;
+    QtConcurrent::blockingMap(rows, [&small_source, &small_reference](Match_Row &row) {
+        const QImage &image = small_reference.at(row.reference);
+        row.costs.resize(small_source.length());
+        for (int s=0; s < small_source.length(); s++)
+            row.costs[s] = qMax(0.0, image_difference(image, small_source.at(s)));
+    });
+
+    /*
+     * total[s] is the least total difference of matching the reference frames so far, the last one to source frame s
+     * or earlier. from[r][s] is the source frame that reference frame r is then matched to.
+     */
+    int source_count = source.length();
+    QVector<qreal>total(source_count, 0.0);
+    QVector<QVector<int>>from(rows.length(), QVector<int>(source_count));
+    for (int r=0; r < rows.length(); r++){
+        qreal best = 0.0;
+        int best_source = 0;
+        for (int s=0; s < source_count; s++){
+            qreal cost = rows.at(r).costs.at(s) + total.at(s);
+            if (s == 0 || cost < best){
+                best = cost;
+                best_source = s;
+            }
+            total[s] = best;
+            from[r][s] = best_source;
+        }
+    }
+
+    content_map.resize(rows.length());
+    int s = source_count - 1;
+    for (int r=rows.length()-1; r >= 0; r--){
+        s = from.at(r).at(s);
+        content_map[r] = s;
+    }
+    *match_error = total.last() / rows.length();
+    return content_map;
+}
+
+struct Fit_Candidate
+{
+    qreal x1, y1, x2, y2;
+    qreal error;
+};
+
+//rms difference in source frames of easing over [first, last] of content_map from the source frames matched
+static qreal easing_error(const Easing_Table &easing, const QVector<int> &content_map, int first, int last)
+{
+    qreal from = content_map.at(first);
+    qreal range = content_map.at(last) - from;
+    qreal sum = 0.0;
+    for (int i=first; i <= last; i++){
+        qreal x = last > first ? (qreal)(i - first) / (last - first) : 0.0;
+        qreal error = from + easing.ease(x) * range - content_map.at(i);
+        sum += error * error;
+    }
+    return qSqrt(sum / (last - first + 1));
+}
+
+/*
+ * cubic-bezier best fitting [first, last] of content_map, scaled from the source frame matched at first to the one at
+ * last. A grid of control points is scored in parallel and the best refined by coordinate descent.
+ */
+static Easing_Table fit_segment(const QVector<int> &content_map, int first, int last, qreal *rms_error)
+{
+    auto score = [&content_map, first, last](Fit_Candidate &candidate) {
+        candidate.error = easing_error(Easing_Table(candidate.x1, candidate.y1, candidate.x2, candidate.y2),
+                                       content_map, first, last);
+    };
+    auto by_error = [](const Fit_Candidate &a, const Fit_Candidate &b) { return a.error < b.error; };
+
+    //x within [0, 1] so time runs forward, y overshooting by up to half for back/elastic-like curves
+    QVector<Fit_Candidate>candidates;
+    for (int a=0; a < EXTRACTION_FIT_GRID_STEPS; a++)
+        for (int b=0; b < EXTRACTION_FIT_GRID_STEPS; b++)
+            for (int c=0; c < EXTRACTION_FIT_GRID_STEPS; c++)
+                for (int d=0; d < EXTRACTION_FIT_GRID_STEPS; d++){
+                    qreal step = 1.0 / (EXTRACTION_FIT_GRID_STEPS - 1);
+                    candidates.append({a * step, b * step * 2 - 0.5, c * step, d * step * 2 - 0.5, 0.0});
+                }
+    QtConcurrent::blockingMap(candidates, score);
+    Fit_Candidate best = *std::min_element(candidates.begin(), candidates.end(), by_error);
+
+    qreal step = 0.5 / (EXTRACTION_FIT_GRID_STEPS - 1);
+    for (int pass=0; pass < EXTRACTION_FIT_REFINE_PASSES; pass++){
+        QVector<Fit_Candidate>neighbours;
+        for (int sign=-1; sign <= 1; sign += 2){
+            neighbours.append({qBound(0.0, best.x1 + sign * step, 1.0), best.y1, best.x2, best.y2, 0.0});
+            neighbours.append({best.x1, best.y1 + sign * step, best.x2, best.y2, 0.0});
+            neighbours.append({best.x1, best.y1, qBound(0.0, best.x2 + sign * step, 1.0), best.y2, 0.0});
+            neighbours.append({best.x1, best.y1, best.x2, best.y2 + sign * step, 0.0});
+        }
+        QtConcurrent::blockingMap(neighbours, score);
+        Fit_Candidate neighbour = *std::min_element(neighbours.begin(), neighbours.end(), by_error);
+        if (neighbour.error < best.error)
+            best = neighbour;
+        else
+            step /= 2;
+    }
+
+    *rms_error = best.error;
+    return Easing_Table(best.x1, best.y1, best.x2, best.y2);
+}
+
+/*
+ * cubic-bezier best fitting content_map over the whole source sequence, as deployed by retime_with_easing. The first
+ * and last reference frames are taken to be the first and last source frames.
+ */
+Easing_Table Curve_Extraction::fit_easing(const QVector<int> &content_map, int src_frame_count, qreal *rms_error)
+{
+    *rms_error = 0.0;
+    if (content_map.length() < 2 || src_frame_count < 2)
+        return Easing_Table();
+
+    QVector<int>pinned = content_map;
+    pinned.first() = 0;
+    pinned.last() = src_frame_count - 1;
+    return fit_segment(pinned, 0, pinned.length() - 1, rms_error);
+}
+
+/*
+ * Keyframe_Timeline fitting content_map. Keyframes are placed where the matching turns most (Ramer-Douglas-Peucker,
+ * within EXTRACTION_KEYFRAME_TOLERANCE frames) and each segment is given its own fitted easing, or is a hold.
+ */
+Keyframe_Timeline Curve_Extraction::fit_keyframes(const QVector<int> &content_map, int src_frame_count, qreal *rms_error)
+{
+    Keyframe_Timeline keyframes;
+    *rms_error = 0.0;
+    int length = content_map.length();
+    if (length < 2)
+        return keyframes;
+
+    QVector<bool>is_keyframe(length, false);
+    is_keyframe.first() = true;
+    is_keyframe.last() = true;
+    QVector<QPair<int, int>>spans = {{0, length - 1}};
+    while (!spans.isEmpty()){
+        QPair<int, int> span = spans.takeLast();
+        int first = span.first, last = span.second;
+        qreal farthest = 0.0;
+        int split = -1;
+        for (int i=first+1; i < last; i++){
+            qreal line = content_map.at(first) + (qreal)(content_map.at(last) - content_map.at(first)) * (i - first) / (last - first);
+            if (qAbs(content_map.at(i) - line) > farthest){
+                farthest = qAbs(content_map.at(i) - line);
+                split = i;
+            }
+        }
+        if (split >= 0 && farthest > EXTRACTION_KEYFRAME_TOLERANCE){
+            is_keyframe[split] = true;
+            spans.append({first, split});
+            spans.append({split, last});
+        }
+    }
+
+    int first = 0;
+    for (int i=1; i < length; i++){
+        if (!is_keyframe.at(i))
+            continue;
+        qreal segment_error;
+        Easing_Table easing = (content_map.at(first) == content_map.at(i)) ? Easing_Table(0.0, 0.0, 1.0, 1.0)
+                                                                            : fit_segment(content_map, first, i, &segment_error);
+        keyframes.add_keyframe(first, content_map.at(first), easing);
+        first = i;
+    }
+    keyframes.add_keyframe(length - 1, content_map.last(), Easing_Table(0.0, 0.0, 1.0, 1.0));
+
+    QVector<int>retimed = keyframes.retime(length, src_frame_count);
+    qreal sum = 0.0;
+    for (int i=0; i < length; i++)
+        sum += qreal(retimed.at(i) - content_map.at(i)) * (retimed.at(i) - content_map.at(i));
+    *rms_error = qSqrt(sum / length);
+    return keyframes;
+}
+
+//Match reference against source and fit both a cubic-bezier and a Keyframe_Timeline to the matching
+Extracted_Curve Curve_Extraction::extract(const QVector<QImage> &source, const QVector<QImage> &reference)
+{
+    Extracted_Curve curve;
+    curve.content_map = match_frames(source, reference, &curve.match_error);
+    curve.easing = fit_easing(curve.content_map, source.length(), &curve.easing_error);
+    curve.keyframes = fit_keyframes(curve.content_map, source.length(), &curve.keyframes_error);
+    return curve;
+}
+
+//keyframes of a sequence of from_frame_count frames moved in proportion to one of to_frame_count frames
+Keyframe_Timeline Curve_Extraction::rescale(const Keyframe_Timeline &keyframes, int from_frame_count, int to_frame_count)
+{
+    Keyframe_Timeline rescaled;
+    for (int i=0; i < keyframes.frames.length(); i++){
+        int frame = from_frame_count > 1 ? qRound((qreal)keyframes.frames.at(i) * (to_frame_count - 1) / (from_frame_count - 1)) : 0;
+        rescaled.add_keyframe(frame, keyframes.src_frames.at(i), keyframes.easings.at(i));
+    }
+    return rescaled;
+}
@@ -0,0 +1,61 @@
+#ifndef CURVE_EXTRACTION_H
+#define CURVE_EXTRACTION_H
+
+#include <QtGlobal>
+#include <QImage>
+#include <QJsonObject>
+#include <QVector>
+#include "easing_table.h"
+#include "keyframe_timeline.h"
+
+/*
+ * EXTRACTION_MATCH_WIDTH         - frames are compared scaled to this width, which is plenty to tell frames apart
+ * EXTRACTION_FIT_GRID_STEPS      - control point values tried per coordinate before refining the best fit
+ * EXTRACTION_FIT_REFINE_PASSES   - refinement passes, each moving one coordinate or halving the step
+ * EXTRACTION_KEYFRAME_TOLERANCE  - keyframes are added until the timeline is within this many source frames of the
+ *                                  matched frames. A cubic-bezier fit further off than this is not deployed
+ */
+#define EXTRACTION_MATCH_WIDTH 128
+#define EXTRACTION_FIT_GRID_STEPS 9
+#define EXTRACTION_FIT_REFINE_PASSES 12
+#define EXTRACTION_KEYFRAME_TOLERANCE 1.5
+
+/*
+ * Extracted_Curve is the timing of a reference animation relative to the linear source animation
+ *   content_map     - source frame matched to each reference frame
+ *   match_error     - mean image difference (0 to 255) of the matched frames. High if the animations differ
+ *   easing          - cubic-bezier best fitting content_map, easing_error its rms error in source frames
+ *   keyframes       - Keyframe_Timeline fitting content_map (eg with holds), keyframes_error its rms error
+ */
+struct Extracted_Curve
+{
+    QVector<int> content_map;
+    qreal match_error = 0.0;
+    Easing_Table easing;
+    qreal easing_error = 0.0;
+    Keyframe_Timeline keyframes;
+    qreal keyframes_error = 0.0;
+
+    QString easing_name() const;
+    QJsonObject to_json() const;
+};
+
+/*
+ * Curve_Extraction estimates the time remapping of an eased reference animation from the linear source animation
+ * it was made from, so that its feel can be deployed rather than guessed at. Every reference frame is compared with
+ * every source frame (the vectorized image_difference kernel, reference frames in parallel) and the matching which
+ * only moves forward in time with the least total difference is chosen. A cubic-bezier and a Keyframe_Timeline are
+ * then fitted to the matching, the candidate curves scored in parallel.
+ */
+class Curve_Extraction
+{
+public:
+    static QVector<int> match_frames(const QVector<QImage> &source, const QVector<QImage> &reference, qreal *match_error);
+    static Easing_Table fit_easing(const QVector<int> &content_map, int src_frame_count, qreal *rms_error);
+    static Keyframe_Timeline fit_keyframes(const QVector<int> &content_map, int src_frame_count, qreal *rms_error);
+    static Extracted_Curve extract(const QVector<QImage> &source, const QVector<QImage> &reference);
+    static Keyframe_Timeline rescale(const Keyframe_Timeline &keyframes, int from_frame_count, int to_frame_count);
+    static QVector<QImage> read_sequence(const QString &directory);
+};
+
+#endif // CURVE_EXTRACTION_H
@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <QtConcurrent>
+#include "curve_sweep.h"
+#include "fixed_point_retimer.h"
+#include "bezier_curve.h"
+
+Curve_Sweep::Curve_Sweep(const QPoint &p0, const QPoint &p1, int frame_count)
+{
+    this->p0 = p0;
+    this->p1 = p1;
+    this->frame_count = frame_count;
+    this->evaluated_count = 0;
+}
+
+/*
+ * Target source frame at each index - easing's progress scaled to the Frames. eg Easing_Table(0.42, 0, 1, 1) for an
+ * ease-in
+ */
+void Curve_Sweep::set_target_profile(const Easing_Table &easing)
+{
+    target_profile.clear();
+    int last = frame_count - 1;
+    for (int i=0; i < frame_count; i++)
+        target_profile.append(last > 0 ? easing.ease((qreal)i / last) * last : 0.0);
+}
+
+void Curve_Sweep::clear_target_profile()
+{
+    target_profile.clear();
+}
+
+//Retime candidate.points and score the retiming. Only reads this, so can be run on any thread
+void Curve_Sweep::evaluate(Sweep_Candidate &candidate) const
+{
+    Fixed_Point_Retimer retimer(candidate.points);
+    QList<int>skip_list = retimer.calculate_skip_extend_index_list(frame_count);
+    QList<float>skip_extend_index_list;
+    for (int i=0; i < skip_list.length(); i++)
+        skip_extend_index_list.append(skip_list.at(i));
+    candidate.content_map = content_map_from_timeline(Bezier_Curve::reinterpolate_timeline(skip_extend_index_list, frame_count));
+
+    const QVector<int> &content_map = candidate.content_map;
+    qreal target_error = 0.0;
+    if (!target_profile.isEmpty()){
+        for (int i=0; i < content_map.length(); i++){
+            qreal error = content_map.at(i) - target_profile.value(i);
+            target_error += error * error;
+        }
+        target_error /= qMax(1, content_map.length());
+    }
+
+    qreal smoothness = 0.0;
+    for (int i=2; i < content_map.length(); i++){
+        int step_change = (content_map.at(i) - content_map.at(i-1)) - (content_map.at(i-1) - content_map.at(i-2));
+        smoothness += step_change * step_change;
+    }
+    smoothness /= qMax(1, content_map.length() - 2);
+
+    candidate.score = target_error + SWEEP_SMOOTHNESS_WEIGHT * smoothness;
+}
+
+//Score all points_list on all cores
+QVector<Sweep_Candidate> Curve_Sweep::evaluate_all(const QVector<Bezier_Points> &points_list)
+{
+    QVector<Sweep_Candidate>candidates(points_list.length());
+    for (int i=0; i < points_list.length(); i++)
+        candidates[i].points = points_list.at(i);
+
+    QtConcurrent::blockingMap(candidates, [this](Sweep_Candidate &candidate) {
+        evaluate(candidate);
+    });
+    evaluated_count += candidates.length();
+
+    return candidates;
+}
+
+static bool same_points(const Bezier_Points &a, const Bezier_Points &b)
+{
+    return a.p0 == b.p0 && a.c1 == b.c1 && a.c2 == b.c2 && a.p1 == b.p1;
+}
+
+/*
+ * Local search around candidate - move one control point coordinate by +/-step while the score improves, halving the
+ * step when no move improves it. Control points are kept within the horizontal extent of the curve so that time
+ * always runs forward.
+ */
+Sweep_Candidate Curve_Sweep::refine(const Sweep_Candidate &candidate, int step)
+{
+    int min_x = qMin(p0.x(), p1.x());
+    int max_x = qMax(p0.x(), p1.x());
+    Sweep_Candidate best = candidate;
+
+    for (int pass=0; pass < SWEEP_REFINE_PASSES && step > 0; pass++){
+        QVector<Bezier_Points>neighbours;
+        for (int coordinate=0; coordinate < 4; coordinate++){
+            for (int sign=-1; sign <= 1; sign += 2){
+                Bezier_Points points = best.points;
+                QPoint &control = (coordinate < 2) ? points.c1 : points.c2;
+                if (coordinate % 2 == 0)
+                    control.setX(qBound(min_x, control.x() + sign * step, max_x));
+                else
+                    control.setY(control.y() + sign * step);
+                if (!same_points(points, best.points))
+                    neighbours.append(points);
+            }
+        }
+
+        bool improved = false;
+        QVector<Sweep_Candidate>scored = evaluate_all(neighbours);
+        for (int i=0; i < scored.length(); i++){
+            if (scored.at(i).score < best.score){
+                best = scored.at(i);
+                improved = true;
+            }
+        }
+        if (!improved)
+            step = step / 2;
+    }
+
+    return best;
+}
+
+/*
+ * Returns up to count distinct candidates, best first. The grid spans the bounding box of p0 and p1, extended by half
+ * its height above and below so that overshooting control points (eg an S-shaped curve) are tried too.
+ */
+QVector<Sweep_Candidate> Curve_Sweep::sweep(int count)
+{
+    evaluated_count = 0;
+    QVector<Sweep_Candidate>ranked;
+    if (frame_count < 2 || count < 1)
+        return ranked;
+
+    int min_x = qMin(p0.x(), p1.x());
+    int width = qAbs(p1.x() - p0.x());
+    int height = qMax(1, qAbs(p1.y() - p0.y()));
+    int min_y = qMin(p0.y(), p1.y()) - height / 2;
+    int grid_height = height * 2;
+
+    QVector<int>xs, ys;
+    for (int i=0; i < SWEEP_GRID_STEPS; i++){
+        xs.append(min_x + width * i / (SWEEP_GRID_STEPS - 1));
+        ys.append(min_y + grid_height * i / (SWEEP_GRID_STEPS - 1));
+    }
+
+    QVector<Bezier_Points>points_list;
+    for (int c1x=0; c1x < SWEEP_GRID_STEPS; c1x++)
+        for (int c1y=0; c1y < SWEEP_GRID_STEPS; c1y++)
+            for (int c2x=0; c2x < SWEEP_GRID_STEPS; c2x++)
+                for (int c2y=0; c2y < SWEEP_GRID_STEPS; c2y++)
+                    points_list.append({p0, QPoint(xs.at(c1x), ys.at(c1y)), QPoint(xs.at(c2x), ys.at(c2y)), p1});
+
+    QVector<Sweep_Candidate>candidates = evaluate_all(points_list);
+    auto by_score = [](const Sweep_Candidate &a, const Sweep_Candidate &b) { return a.score < b.score; };
+    std::stable_sort(candidates.begin(), candidates.end(), by_score);
+
+    //Refine twice as many as asked for, as several may converge on the same curve
+    int step = qMax(1, qMax(width, grid_height) / (SWEEP_GRID_STEPS - 1) / 2);
+    QVector<Sweep_Candidate>refined;
+    for (int i=0; i < candidates.length() && i < count * 2; i++)
+        refined.append(refine(candidates.at(i), step));
+    std::stable_sort(refined.begin(), refined.end(), by_score);
+
+    for (int i=0; i < refined.length() && ranked.length() < count; i++){
+        bool duplicate = false;
+        for (int j=0; j < ranked.length() && !duplicate; j++)
+            duplicate = same_points(ranked.at(j).points, refined.at(i).points);
+        if (!duplicate)
+            ranked.append(refined.at(i));
+    }
+
+    return ranked;
+}
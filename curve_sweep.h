@@ -0,0 +1,59 @@
+#ifndef CURVE_SWEEP_H
+#define CURVE_SWEEP_H
+
+#include <QtGlobal>
+#include <QVector>
+#include "bezier_points.h"
+#include "easing_table.h"
+
+/*
+ * SWEEP_GRID_STEPS       - positions tried per control point coordinate, ie SWEEP_GRID_STEPS^4 candidate curves
+ * SWEEP_REFINE_PASSES    - passes of the local search around each of the best candidates, halving the step each pass
+ * SWEEP_SMOOTHNESS_WEIGHT - weight of the smoothness term against the target profile term of the score
+ */
+#define SWEEP_GRID_STEPS 8
+#define SWEEP_REFINE_PASSES 6
+#define SWEEP_SMOOTHNESS_WEIGHT 0.25
+
+/*
+ * A candidate Bezier Curve and its score - lower is better. content_map is the original Frame shown at each index
+ * when the curve is deployed.
+ */
+struct Sweep_Candidate
+{
+    Bezier_Points points;
+    qreal score;
+    QVector<int> content_map;
+};
+
+/*
+ * Curve_Sweep searches the control points c1, c2 of a Bezier Curve from p0 to p1 for the curves whose retiming best
+ * matches a target timing profile and/or is the smoothest.
+ *   score = mean squared distance of the retimed source frame from the target profile
+ *         + SWEEP_SMOOTHNESS_WEIGHT * mean squared change of the step between consecutive source frames
+ * Without a target profile, only smoothness is scored.
+ *
+ * Each candidate is retimed with Fixed_Point_Retimer and Bezier_Curve::reinterpolate_timeline - integer only and
+ * bypassing Retime_Cache - and candidates are evaluated on all cores. sweep() scores a grid of control points over
+ * the curve's bounding box, then refines the best candidates by a local search with shrinking steps.
+ */
+class Curve_Sweep
+{
+public:
+    Curve_Sweep(const QPoint &p0, const QPoint &p1, int frame_count);
+    QPoint p0, p1;
+    int frame_count;
+    QVector<qreal>target_profile;
+    qint64 evaluated_count;
+
+    void set_target_profile(const Easing_Table &easing);
+    void clear_target_profile();
+    QVector<Sweep_Candidate> sweep(int count = 5);
+    void evaluate(Sweep_Candidate &candidate) const;
+
+private:
+    QVector<Sweep_Candidate> evaluate_all(const QVector<Bezier_Points> &points_list);
+    Sweep_Candidate refine(const Sweep_Candidate &candidate, int step);
+};
+
+#endif // CURVE_SWEEP_H
@@ -0,0 +1,93 @@
+#include "deploy_worker.h"
+#include "bezier_curve.h"
+#include "motion_blur.h"
+
+Deploy_Worker::Deploy_Worker(QObject *parent)
+    : QThread{parent}
+{
+    generation = 0;
+    run_generation = 0;
+    fixed_point = false;
+    motion_blur = false;
+    begin_angle = 0.0;
+}
+
+/*
+ * Start deploying points on frame_list (the original Frames). Call from the GUI thread while the worker is not running.
+ * Only the images are taken from the Frames - QImage copies share the pixels so this is cheap.
+ */
+void Deploy_Worker::start_deploy(const Bezier_Points &points, bool fixed_point, qreal begin_angle, QList<Frame *>frame_list,
+                                 bool motion_blur)
+{
+    this->points = points;
+    this->fixed_point = fixed_point;
+    this->motion_blur = motion_blur;
+    this->begin_angle = begin_angle;
+
+    source_images.clear();
+    for (int i=0; i < frame_list.length(); i++)
+        source_images.append(*frame_list.at(i)->image);
+
+    degrees_list.clear();
+    skip_extend_index_list.clear();
+    timeline.clear();
+    back_buffer.clear();
+    cancelled.storeRelease(0);
+
+    //deploy_ready() of an earlier deploy still queued to the GUI thread is recognised as stale by its generation
+    generation++;
+    run_generation = generation;
+    start();
+}
+
+/*
+ * Request the worker to stop. deploy_ready() is not emitted for a cancelled deploy, and one already emitted (or from a
+ * deploy already complete) is left stale, as generation no longer matches it. Call from the GUI thread
+ */
+void Deploy_Worker::cancel()
+{
+    cancelled.storeRelease(1);
+    generation++;
+}
+
+bool Deploy_Worker::is_cancelled()
+{
+    return cancelled.loadAcquire() != 0;
+}
+
+void Deploy_Worker::run()
+{
+    int frame_count = source_images.length();
+    emit progress(0);
+
+    Bezier_Curve::compute_retiming(points, fixed_point, begin_angle, frame_count, &degrees_list, &skip_extend_index_list);
+    if (is_cancelled())
+        return;
+    emit progress(10);
+
+    timeline = Bezier_Curve::reinterpolate_timeline(skip_extend_index_list, frame_count);
+    if (is_cancelled())
+        return;
+    emit progress(20);
+
+    //Build the back buffer, one image per slot of the timeline
+    int percent = 20;
+    back_buffer.reserve(frame_count);
+    for (int i=0; i < timeline.length(); i++){
+        if (is_cancelled())
+            return;
+
+        if (motion_blur)
+            back_buffer.append(Motion_Blur::blurred_slot(timeline, i, source_images));
+        else
+            back_buffer.append(source_images.at(timeline.content_index.at(i)));
+
+        int new_percent = 20 + (80 * (i+1)) / timeline.length();
+        if (new_percent != percent){
+            percent = new_percent;
+            emit progress(percent);
+        }
+    }
+
+    emit deploy_ready(run_generation);
+}
@@ -0,0 +1,54 @@
+#ifndef DEPLOY_WORKER_H
+#define DEPLOY_WORKER_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QImage>
+#include <QVector>
+#include "frame.h"
+#include "bezier_points.h"
+#include "retime_timeline.h"
+
+/*
+ * Deploy_Worker deploys a Bezier Curve on its own thread so that the GUI (and playback) carries on meanwhile.
+ * The new timeline and its images are built into a back buffer (timeline, back_buffer) from the original Frames.
+ * deploy_ready() is emitted when complete, upon which the GUI thread swaps the back buffer in (see
+ * MainWindow::swap_in_deploy). Nothing shown on screen is modified by the worker.
+ * With motion_blur, the frames skipped over are blended into each slot which skips (see Motion_Blur).
+ */
+class Deploy_Worker : public QThread
+{
+    Q_OBJECT
+public:
+    explicit Deploy_Worker(QObject *parent = nullptr);
+
+    void start_deploy(const Bezier_Points &points, bool fixed_point, qreal begin_angle, QList<Frame *>frame_list,
+                      bool motion_blur = false);
+    void cancel();
+    bool is_cancelled();
+
+    //Back buffer, valid once deploy_ready() is emitted with the current generation. cancel() moves generation on
+    int generation;
+    Bezier_Points points;
+    QList<qreal>degrees_list;
+    QList<float>skip_extend_index_list;
+    Retime_Timeline timeline;
+    QVector<QImage>back_buffer;
+
+signals:
+    void progress(int percent);
+    void deploy_ready(int generation);
+
+protected:
+    void run() override;
+
+private:
+    bool fixed_point;
+    bool motion_blur;
+    qreal begin_angle;
+    int run_generation;
+    QVector<QImage>source_images;
+    QAtomicInt cancelled;
+};
+
+#endif // DEPLOY_WORKER_H
@@ -0,0 +1,66 @@
+#include <QStringList>
+#include <QRegularExpression>
+#include "easing_policy.h"
+
+//The policies are constexpr - check their end points and midpoints at compile time
+static_assert(Linear_Easing().ease(0.5) == 0.5, "Linear_Easing");
+static_assert(Power_Ease_In<2>().ease(0.5) == 0.25, "Power_Ease_In");
+static_assert(Power_Ease_Out<2>().ease(0.5) == 0.75, "Power_Ease_Out");
+static_assert(Power_Ease_In_Out<3>().ease(0.5) == 0.5 && Power_Ease_In_Out<3>().ease(1.0) == 1.0, "Power_Ease_In_Out");
+static_assert(Smoothstep_Easing().ease(0.0) == 0.0 && Smoothstep_Easing().ease(1.0) == 1.0, "Smoothstep_Easing");
+
+//Linear easing
+Easing_Function::Easing_Function()
+    : Easing_Function(Linear_Easing(), "linear")
+{
+}
+
+//Names accepted by from_name, besides "cubic-bezier(x1, y1, x2, y2)"
+QStringList Easing_Function::names()
+{
+    return {"linear", "ease-in-quad", "ease-out-quad", "ease-in-out-quad", "ease-in-cubic", "ease-out-cubic",
+            "ease-in-out-cubic", "smoothstep"};
+}
+
+/*
+ * Easing_Function for a name from a config, eg "ease-in-out-cubic" or "cubic-bezier(0.42, 0, 0.58, 1)" (an
+ * Easing_Table). An unknown name gives linear easing and *ok false.
+ */
+Easing_Function Easing_Function::from_name(const QString &name, bool *ok)
+{
+    QString key = name.trimmed().toLower();
+    if (ok)
+        *ok = true;
+
+    if (key == "linear")
+        return Easing_Function(Linear_Easing(), key);
+    if (key == "ease-in-quad")
+        return Easing_Function(Power_Ease_In<2>(), key);
+    if (key == "ease-out-quad")
+        return Easing_Function(Power_Ease_Out<2>(), key);
+    if (key == "ease-in-out-quad")
+        return Easing_Function(Power_Ease_In_Out<2>(), key);
+    if (key == "ease-in-cubic")
+        return Easing_Function(Power_Ease_In<3>(), key);
+    if (key == "ease-out-cubic")
+        return Easing_Function(Power_Ease_Out<3>(), key);
+    if (key == "ease-in-out-cubic")
+        return Easing_Function(Power_Ease_In_Out<3>(), key);
+    if (key == "smoothstep")
+        return Easing_Function(Smoothstep_Easing(), key);
+
+    QRegularExpression bezier_regex("^cubic-bezier\\(([^,]+),([^,]+),([^,]+),([^,]+)\\)$");
+    QRegularExpressionMatch match = bezier_regex.match(key);
+    if (match.hasMatch()){
+        qreal values[4];
+        bool valid = true;
+        for (int i=0; i < 4 && valid; i++)
+            values[i] = match.captured(i+1).trimmed().toDouble(&valid);
+        if (valid)
+            return Easing_Function(Easing_Table(values[0], values[1], values[2], values[3]), key);
+    }
+
+    if (ok)
+        *ok = false;
+    return Easing_Function();
+}
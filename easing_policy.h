@@ -0,0 +1,118 @@
+#ifndef EASING_POLICY_H
+#define EASING_POLICY_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QVector>
+#include <QSharedPointer>
+#include "easing_table.h"
+
+/*
+ * Easing policies - any type with a member
+ *     qreal ease(qreal x) const
+ * mapping the fraction of time elapsed x (0 to 1) to the fraction of the animation progressed. Policies are passed by
+ * type to retime_with_easing, so the call to ease() is resolved at compile time and inlined into the retiming loop.
+ * The policies below are constexpr so that they can be evaluated (and checked) at compile time too. Easing_Table is a
+ * policy as well, for Bezier easing curves.
+ *
+ *   eg retime_with_easing(Power_Ease_In_Out<3>(), NUMBER_FRAMES, NUMBER_FRAMES)
+ *
+ * Easing_Function wraps any policy behind one runtime type, for curves chosen by name at runtime (see from_name).
+ */
+struct Linear_Easing
+{
+    constexpr qreal ease(qreal x) const { return x; }
+};
+
+//x^Power
+template<int Power>
+struct Power_Ease_In
+{
+    constexpr qreal ease(qreal x) const
+    {
+        qreal y = 1.0;
+        for (int i=0; i < Power; i++)
+            y = y * x;
+        return y;
+    }
+};
+
+//1 - (1-x)^Power
+template<int Power>
+struct Power_Ease_Out
+{
+    constexpr qreal ease(qreal x) const { return 1.0 - Power_Ease_In<Power>().ease(1.0 - x); }
+};
+
+//Power_Ease_In over the first half of the time, Power_Ease_Out over the second
+template<int Power>
+struct Power_Ease_In_Out
+{
+    constexpr qreal ease(qreal x) const
+    {
+        return x < 0.5 ? Power_Ease_In<Power>().ease(2*x) / 2 : 0.5 + Power_Ease_Out<Power>().ease(2*x - 1) / 2;
+    }
+};
+
+//3x^2 - 2x^3
+struct Smoothstep_Easing
+{
+    constexpr qreal ease(qreal x) const { return x * x * (3.0 - 2.0 * x); }
+};
+
+/*
+ * Content map of frame_count indexes over src_frame_count source frames - the source frame shown at each index is the
+ * eased progress at that index, rounded to the nearest frame
+ */
+template<typename Easing>
+QVector<int> retime_with_easing(const Easing &easing, int frame_count, int src_frame_count)
+{
+    QVector<int>content_map(qMax(0, frame_count));
+    int last = src_frame_count - 1;
+    for (int i=0; i < frame_count; i++){
+        qreal x = frame_count > 1 ? (qreal)i / (frame_count-1) : 0.0;
+        content_map[i] = qBound(0, qRound(easing.ease(x) * last), qMax(0, last));
+    }
+    return content_map;
+}
+
+/*
+ * Easing_Function holds any easing policy behind a virtual call. It is itself a policy, so it can be passed to
+ * retime_with_easing where the curve is only known at runtime. Copies share the policy.
+ */
+class Easing_Function
+{
+public:
+    Easing_Function();
+    template<typename Easing>
+    Easing_Function(const Easing &easing, const QString &name = QString())
+        : holder(new Easing_Holder<Easing>(easing)), name(name)
+    {
+    }
+
+    qreal ease(qreal x) const { return holder->ease(x); }
+    QString function_name() const { return name; }
+
+    static Easing_Function from_name(const QString &name, bool *ok = nullptr);
+    static QStringList names();
+
+private:
+    struct Easing_Base
+    {
+        virtual ~Easing_Base() {}
+        virtual qreal ease(qreal x) const = 0;
+    };
+
+    template<typename Easing>
+    struct Easing_Holder : public Easing_Base
+    {
+        explicit Easing_Holder(const Easing &easing) : easing(easing) {}
+        qreal ease(qreal x) const override { return easing.ease(x); }
+        Easing easing;
+    };
+
+    QSharedPointer<const Easing_Base>holder;
+    QString name;
+};
+
+#endif // EASING_POLICY_H
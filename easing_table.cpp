@@ -0,0 +1,73 @@
+#include "easing_table.h"
+
+//Linear easing
+Easing_Table::Easing_Table()
+    : Easing_Table(0.0, 0.0, 1.0, 1.0)
+{
+}
+
+Easing_Table::Easing_Table(qreal x1, qreal y1, qreal x2, qreal y2)
+{
+    this->x1 = qBound(0.0, x1, 1.0);
+    this->y1 = y1;
+    this->x2 = qBound(0.0, x2, 1.0);
+    this->y2 = y2;
+    setup_table();
+}
+
+/*
+ * Normalize Bezier points in Bezier Curve Window coordinates ((0,0) on the top Left, p0 bottom left, p1 top right)
+ * to an easing curve
+ */
+Easing_Table Easing_Table::from_bezier_points(const Bezier_Points &points)
+{
+    qreal width = points.p1.x() - points.p0.x();
+    qreal height = points.p0.y() - points.p1.y();
+    if (width == 0 || height == 0)
+        return Easing_Table();
+
+    return Easing_Table((points.c1.x() - points.p0.x()) / width, (points.p0.y() - points.c1.y()) / height,
+                        (points.c2.x() - points.p0.x()) / width, (points.p0.y() - points.c2.y()) / height);
+}
+
+//One coordinate of the normalized cubic at t, with end points 0 and 1
+static inline qreal cubic_at(qreal t, qreal c1, qreal c2)
+{
+    qreal u = 1.0 - t;
+    return 3*u*u*t*c1 + 3*u*t*t*c2 + t*t*t;
+}
+
+/*
+ * For each x in the table, find t of the curve where x(t) = x (bisection, x(t) is monotonic since x1 and x2 are
+ * within 0 to 1) and store y(t)
+ */
+void Easing_Table::setup_table()
+{
+    table.resize(EASING_TABLE_SIZE);
+    for (int i=0; i < EASING_TABLE_SIZE; i++){
+        qreal x = (qreal)i / (EASING_TABLE_SIZE-1);
+        qreal t_low = 0.0;
+        qreal t_high = 1.0;
+        for (int iteration=0; iteration < 40; iteration++){
+            qreal t = (t_low + t_high) / 2;
+            if (cubic_at(t, x1, x2) < x)
+                t_low = t;
+            else
+                t_high = t;
+        }
+        table[i] = cubic_at((t_low + t_high) / 2, y1, y2);
+    }
+}
+
+qreal Easing_Table::ease(qreal x) const
+{
+    if (x <= 0.0)
+        return table.first();
+    if (x >= 1.0)
+        return table.last();
+
+    qreal position = x * (EASING_TABLE_SIZE-1);
+    int index = (int)position;
+    qreal fraction = position - index;
+    return table.at(index) + (table.at(index+1) - table.at(index)) * fraction;
+}
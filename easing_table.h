@@ -0,0 +1,31 @@
+#ifndef EASING_TABLE_H
+#define EASING_TABLE_H
+
+#include <QtGlobal>
+#include <QVector>
+#include "bezier_points.h"
+
+//Number of precalculated entries of an Easing_Table
+#define EASING_TABLE_SIZE 257
+
+/*
+ * Easing_Table is a cubic Bezier easing curve normalized from (0,0) to (1,1) with control points (x1,y1) and (x2,y2),
+ * precalculated into EASING_TABLE_SIZE entries so that ease() is a table lookup and a linear interpolation.
+ * x is the fraction of time elapsed, ease(x) the fraction of the animation progressed.
+ */
+class Easing_Table
+{
+public:
+    Easing_Table();
+    Easing_Table(qreal x1, qreal y1, qreal x2, qreal y2);
+    static Easing_Table from_bezier_points(const Bezier_Points &points);
+
+    qreal x1, y1, x2, y2;
+    qreal ease(qreal x) const;
+
+private:
+    QVector<qreal>table;
+    void setup_table();
+};
+
+#endif // EASING_TABLE_H
@@ -0,0 +1,185 @@
+#include <QPainter>
+#include <QPaintEvent>
+#include <QMouseEvent>
+#include <QScrollBar>
+#include "filmstrip.h"
+#include "memory_accounting.h"
+
+Filmstrip::Filmstrip(QList<Frame *> *source_frames, QWidget *parent)
+    : QAbstractScrollArea{parent}
+{
+    this->source_frames = source_frames;
+    this->position = 0;
+    this->accounted_bytes = 0;
+    thumbnails.setMaxCost(FILMSTRIP_CACHE_BYTES);
+
+    setWindowTitle("Filmstrip");
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+    setFixedHeight(2 * (thumbnail_size().height() + FILMSTRIP_LABEL_HEIGHT) + 3 * FILMSTRIP_SPACING
+                   + horizontalScrollBar()->sizeHint().height() + 2 * frameWidth());
+    resize(800, height());
+    update_scroll_range();
+}
+
+Filmstrip::~Filmstrip()
+{
+    clear_thumbnails();
+}
+
+//Show timeline in the bottom row. Thumbnails are of the original Frames so stay cached
+void Filmstrip::set_timeline(const Retime_Timeline &timeline)
+{
+    this->timeline = timeline;
+    update_scroll_range();
+    viewport()->update();
+}
+
+//Drop every thumbnail, eg when the original Frames change
+void Filmstrip::clear_thumbnails()
+{
+    thumbnails.clear();
+    update_memory_accounting();
+    viewport()->update();
+}
+
+//Drop the thumbnails of the original Frames at source_indexes, eg when those Frames are reloaded
+void Filmstrip::remove_thumbnails(const QVector<int> &source_indexes)
+{
+    for (int i=0; i < source_indexes.length(); i++)
+        thumbnails.remove(source_indexes.at(i));
+    update_memory_accounting();
+    viewport()->update();
+}
+
+//Highlight the column at position, scrolling it into view
+void Filmstrip::set_position(int position)
+{
+    this->position = position;
+    if (!isVisible())
+        return;
+
+    int left = position * column_width();
+    QScrollBar *scroll_bar = horizontalScrollBar();
+    if (left < scroll_bar->value())
+        scroll_bar->setValue(left);
+    else if (left + column_width() > scroll_bar->value() + viewport()->width())
+        scroll_bar->setValue(left + column_width() - viewport()->width());
+    viewport()->update();
+}
+
+//Size of a thumbnail - FILMSTRIP_THUMBNAIL_WIDTH wide, in the aspect ratio of the first Frame
+QSize Filmstrip::thumbnail_size() const
+{
+    QSize size(FILMSTRIP_THUMBNAIL_WIDTH, FILMSTRIP_THUMBNAIL_WIDTH * 3 / 4);
+    if (!source_frames->isEmpty() && !source_frames->first()->image->isNull())
+        size = source_frames->first()->image->size().scaled(FILMSTRIP_THUMBNAIL_WIDTH, FILMSTRIP_THUMBNAIL_WIDTH * 4,
+                                                            Qt::KeepAspectRatio);
+    return size;
+}
+
+int Filmstrip::column_width() const
+{
+    return thumbnail_size().width() + FILMSTRIP_SPACING;
+}
+
+int Filmstrip::column_count() const
+{
+    return qMax(source_frames->length(), timeline.length());
+}
+
+void Filmstrip::update_scroll_range()
+{
+    QScrollBar *scroll_bar = horizontalScrollBar();
+    scroll_bar->setRange(0, qMax(0, column_count() * column_width() - viewport()->width()));
+    scroll_bar->setPageStep(viewport()->width());
+    scroll_bar->setSingleStep(column_width());
+}
+
+/*
+ * Thumbnail of original Frame source_index, scaled on first use and then kept in the cache. nullptr if there is no
+ * such Frame
+ */
+const QImage *Filmstrip::thumbnail(int source_index)
+{
+    if (source_index < 0 || source_index >= source_frames->length())
+        return nullptr;
+    if (QImage *cached = thumbnails.object(source_index))
+        return cached;
+
+    const QImage *image = source_frames->at(source_index)->image;
+    if (image->isNull())
+        return nullptr;
+    QImage *scaled = new QImage(image->scaled(thumbnail_size(), Qt::KeepAspectRatio, Qt::SmoothTransformation)
+                                     .convertToFormat(QImage::Format_ARGB32_Premultiplied));
+    thumbnails.insert(source_index, scaled, scaled->sizeInBytes());
+    update_memory_accounting();
+    return thumbnails.object(source_index);
+}
+
+void Filmstrip::update_memory_accounting()
+{
+    qint64 bytes = thumbnails.totalCost();
+    if (bytes > accounted_bytes)
+        Memory_Accounting::instance()->add(MEMORY_CACHES, bytes - accounted_bytes);
+    else if (bytes < accounted_bytes)
+        Memory_Accounting::instance()->release(MEMORY_CACHES, accounted_bytes - bytes);
+    accounted_bytes = bytes;
+}
+
+//Paint only the columns intersecting the exposed area
+void Filmstrip::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(viewport());
+    painter.fillRect(event->rect(), palette().window());
+
+    QSize size = thumbnail_size();
+    int width = column_width();
+    int row_height = size.height() + FILMSTRIP_LABEL_HEIGHT;
+    int scroll = horizontalScrollBar()->value();
+    int first = qMax(0, (scroll + event->rect().left()) / width);
+    int last = qMin(column_count() - 1, (scroll + event->rect().right()) / width);
+
+    for (int column=first; column <= last; column++){
+        int x = column * width - scroll + FILMSTRIP_SPACING / 2;
+        QRect original_rect(QPoint(x, FILMSTRIP_SPACING), size);
+        QRect retimed_rect(QPoint(x, 2 * FILMSTRIP_SPACING + row_height), size);
+
+        if (column == position)
+            painter.fillRect(QRect(x - FILMSTRIP_SPACING / 2, 0, width, viewport()->height()), palette().highlight());
+
+        if (const QImage *image = thumbnail(column))
+            painter.drawImage(original_rect, *image);
+        painter.setPen(palette().windowText().color());
+        painter.drawText(QRect(x, original_rect.bottom() + 1, size.width(), FILMSTRIP_LABEL_HEIGHT), Qt::AlignCenter,
+                         QString::number(column));
+
+        if (column >= timeline.length())
+            continue;
+        int content_index = timeline.content_index.at(column);
+        if (const QImage *image = thumbnail(content_index))
+            painter.drawImage(retimed_rect, *image);
+        if (timeline.overwritten.at(column)){
+            painter.setPen(QPen(QColor(255, 140, 0), 2));
+            painter.drawRect(retimed_rect.adjusted(1, 1, -1, -1));
+        }
+        int delta = timeline.delta.at(column);
+        painter.setPen(palette().windowText().color());
+        painter.drawText(QRect(x, retimed_rect.bottom() + 1, size.width(), FILMSTRIP_LABEL_HEIGHT), Qt::AlignCenter,
+                         QString("%1 (%2%3)").arg(content_index).arg(delta > 0 ? "+" : "").arg(delta));
+    }
+}
+
+void Filmstrip::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    update_scroll_range();
+}
+
+//Clicking a column selects its position
+void Filmstrip::mousePressEvent(QMouseEvent *event)
+{
+    int column = (event->pos().x() + horizontalScrollBar()->value()) / column_width();
+    if (column >= 0 && column < column_count())
+        emit position_selected(column);
+}
@@ -0,0 +1,70 @@
+#ifndef FILMSTRIP_H
+#define FILMSTRIP_H
+
+#include <QAbstractScrollArea>
+#include <QCache>
+#include <QImage>
+#include <QList>
+#include "frame.h"
+#include "retime_timeline.h"
+
+/*
+ * FILMSTRIP_THUMBNAIL_WIDTH - width of each thumbnail, the height follows the Frames' aspect ratio
+ * FILMSTRIP_SPACING         - gap between columns and around the rows
+ * FILMSTRIP_LABEL_HEIGHT    - text under each thumbnail
+ * FILMSTRIP_CACHE_BYTES     - thumbnails kept in the cache, least recently used dropped first
+ */
+#define FILMSTRIP_THUMBNAIL_WIDTH 96
+#define FILMSTRIP_SPACING 4
+#define FILMSTRIP_LABEL_HEIGHT 16
+#define FILMSTRIP_CACHE_BYTES (16 * 1024 * 1024)
+
+/*
+ * Filmstrip is a separate window showing the original timeline (top row) over the retimed timeline (bottom row), one
+ * column per slot. Each retimed slot shows a thumbnail of the original Frame it maps to, labelled with its content
+ * index and delta - overwritten slots are outlined. The column at the slider position is highlighted and clicking a
+ * column emits position_selected().
+ *
+ * Only the columns in view are painted, from a QCache of thumbnails keyed by original Frame index, so the cost of a
+ * paint does not depend on the length of the sequence. Both rows share the thumbnail of an original Frame. The
+ * cache is accounted under MEMORY_CACHES.
+ */
+class Filmstrip : public QAbstractScrollArea
+{
+    Q_OBJECT
+public:
+    explicit Filmstrip(QList<Frame *> *source_frames, QWidget *parent = nullptr);
+    ~Filmstrip();
+
+    QList<Frame *> *source_frames;
+    Retime_Timeline timeline;
+    int position;
+
+    void set_timeline(const Retime_Timeline &timeline);
+    void clear_thumbnails();
+    void remove_thumbnails(const QVector<int> &source_indexes);
+
+public slots:
+    void set_position(int position);
+
+signals:
+    void position_selected(int position);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void resizeEvent(QResizeEvent *event);
+    void mousePressEvent(QMouseEvent *event);
+
+private:
+    QCache<int, QImage>thumbnails;
+    qint64 accounted_bytes;
+
+    QSize thumbnail_size() const;
+    int column_width() const;
+    int column_count() const;
+    const QImage *thumbnail(int source_index);
+    void update_scroll_range();
+    void update_memory_accounting();
+};
+
+#endif // FILMSTRIP_H
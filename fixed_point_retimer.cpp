@@ -0,0 +1,185 @@
+#include "fixed_point_retimer.h"
+
+/*
+ * atan(2^-i) in degrees for CORDIC iteration i. Fixed point format is Q32 (degrees * 2^32) so that the rounding of
+ * each entry does not accumulate into the Q16.16 result. Precalculated so that no floating point is needed at runtime.
+ */
+static const qint64 cordic_atan_table[] = {
+    Q_INT64_C(193273528320), Q_INT64_C(114096026022), Q_INT64_C(60285206653),
+    Q_INT64_C(30601712202), Q_INT64_C(15360239180), Q_INT64_C(7687607525),
+    Q_INT64_C(3844741810), Q_INT64_C(1922488225), Q_INT64_C(961258780),
+    Q_INT64_C(480631223), Q_INT64_C(240315841), Q_INT64_C(120157949),
+    Q_INT64_C(60078978), Q_INT64_C(30039490), Q_INT64_C(15019745),
+    Q_INT64_C(7509872), Q_INT64_C(3754936), Q_INT64_C(1877468),
+    Q_INT64_C(938734), Q_INT64_C(469367), Q_INT64_C(234684),
+    Q_INT64_C(117342), Q_INT64_C(58671), Q_INT64_C(29335),
+    Q_INT64_C(14668), Q_INT64_C(7334), Q_INT64_C(3667),
+    Q_INT64_C(1833), Q_INT64_C(917), Q_INT64_C(458),
+    Q_INT64_C(229),
+};
+#define CORDIC_ITERATIONS (int)(sizeof(cordic_atan_table)/sizeof(cordic_atan_table[0]))
+
+/*
+ * Right shift of a negative number is implementation defined before C++20. Shift the magnitude instead so that
+ * the result is identical on every compiler.
+ */
+static inline qint64 shift_right(qint64 value, int shift)
+{
+    if (value >= 0)
+        return value >> shift;
+    return -((-value) >> shift);
+}
+
+/*
+ * Integer division of num/den rounded half away from zero - ie same as round() of the floating point path.
+ * den is expected to be positive
+ */
+static inline qint64 round_divide(qint64 num, qint64 den)
+{
+    if (num >= 0)
+        return (2*num + den) / (2*den);
+    return -((-2*num + den) / (2*den));
+}
+
+Fixed_Point_Retimer::Fixed_Point_Retimer(const Bezier_Points &points)
+{
+    this->points = points;
+    this->begin_angle = 0;
+}
+
+/*
+ * Angle in degrees (Q16.16) of atan(dy/dx) - ie -90 to 90 degrees. Uses CORDIC in vectoring mode which only needs
+ * shifts and adds.
+ * A vertical tangent (dx=0) returns 0 degrees. This is the same as the floating point path which replaces the
+ * infinite slope by 0.
+ */
+fixed_t Fixed_Point_Retimer::atan_degrees(qint64 dy, qint64 dx)
+{
+    if (dx == 0 || dy == 0)
+        return 0;
+
+    bool negative = (dy < 0) != (dx < 0);
+    quint64 x = (quint64)(dx < 0 ? -dx : dx);
+    quint64 y = (quint64)(dy < 0 ? -dy : dy);
+
+    //Normalize the vector to 30-31 bits so that every CORDIC iteration contributes to the precision
+    while ((x | y) >= (Q_UINT64_C(1) << 31)){
+        x >>= 1;
+        y >>= 1;
+    }
+    while ((x | y) < (Q_UINT64_C(1) << 30)){
+        x <<= 1;
+        y <<= 1;
+    }
+
+    //Rotate the vector (x,y) onto the x axis, accumulating the angle rotated
+    qint64 cx = (qint64)x;
+    qint64 cy = (qint64)y;
+    qint64 angle = 0;
+    for (int i=0; i < CORDIC_ITERATIONS && cy != 0; i++){
+        qint64 x_shifted = shift_right(cx, i);
+        qint64 y_shifted = shift_right(cy, i);
+        if (cy > 0){
+            cx = cx + y_shifted;
+            cy = cy - x_shifted;
+            angle = angle + cordic_atan_table[i];
+        } else {
+            cx = cx - y_shifted;
+            cy = cy + x_shifted;
+            angle = angle - cordic_atan_table[i];
+        }
+    }
+
+    //Q32 to Q16.16
+    fixed_t degree = (fixed_t)round_divide(angle, Q_INT64_C(1) << (32 - FIXED_POINT_SHIFT));
+    return negative ? -degree : degree;
+}
+
+//For display and debug only
+qreal Fixed_Point_Retimer::to_qreal(fixed_t value)
+{
+    return (qreal)value / FIXED_POINT_ONE;
+}
+
+/*
+ * Tangent (dx, dy) of the Bezier Curve at percent (0 to FIXED_POINT_PERCENT_STEPS-1).
+ * The percent is mapped linearly to t - ie same as QPainterPath::slopeAtPercent for a single cubic.
+ * The derivative of the cubic is
+ *     3 * ( (c1-p0)*(1-t)^2 + 2*(c2-c1)*t*(1-t) + (p1-c2)*t^2 )
+ * With t = percent/STEPS, the whole derivative is scaled by 3*STEPS^2 which leaves only integers. The scale is
+ * dropped since only dy/dx is of interest, so the tangent is exact.
+ */
+void Fixed_Point_Retimer::tangent_at_percent(int percent, qint64 *dx, qint64 *dy)
+{
+    qint64 t = percent;
+    qint64 u = FIXED_POINT_PERCENT_STEPS - percent;
+
+    *dx = (qint64)(points.c1.x() - points.p0.x()) * u * u
+        + (qint64)(points.c2.x() - points.c1.x()) * 2 * t * u
+        + (qint64)(points.p1.x() - points.c2.x()) * t * t;
+    *dy = (qint64)(points.c1.y() - points.p0.y()) * u * u
+        + (qint64)(points.c2.y() - points.c1.y()) * 2 * t * u
+        + (qint64)(points.p1.y() - points.c2.y()) * t * t;
+}
+
+/*
+ * Setup degrees_list which is the tangent at each point from 0% to 99% along the Bezier Curve.
+ * Same as Bezier_Curve::calculate_bezier_degrees, all degrees are made positive (reference axis is (0,0) on bottom left)
+ * and the begin_angle is the angle of the linear line between the 2 end points.
+ */
+void Fixed_Point_Retimer::calculate_degrees()
+{
+    this->degrees_list.clear();
+    this->begin_angle = atan_degrees(points.p1.y() - points.p0.y(), points.p1.x() - points.p0.x());
+    if (this->begin_angle < 0)
+        this->begin_angle = -this->begin_angle;
+
+    qint64 dx, dy;
+    for (int percent=0; percent < FIXED_POINT_PERCENT_STEPS; percent++){
+        tangent_at_percent(percent, &dx, &dy);
+        fixed_t degree = atan_degrees(dy, dx);
+
+        if (degree > 0)
+            this->degrees_list.append(this->begin_angle);
+        else
+            this->degrees_list.append(-degree);
+    }
+}
+
+/*
+ * Integer equivalent of the skip/extend index calculation in Bezier_Curve::calculate_bezier_degrees.
+ * Each Frame instance is mapped onto degrees_list, and the number of Frames to "accelerate" (+), "slow down" (-)
+ * or maintain sequence (0) is (degree change)/begin_angle rounded half away from zero.
+ */
+QList<int> Fixed_Point_Retimer::calculate_skip_extend_index_list(int frame_count)
+{
+    QList<int>skip_extend_index_list;
+
+    if (this->degrees_list.isEmpty())
+        calculate_degrees();
+
+    qint64 length = this->degrees_list.length();
+    int prev_adjusted_index_topath = 0;
+    for (int i=0; i < frame_count; i++){
+        //round(i * 100/length)
+        int adjusted_index_topath = (int)(((qint64)i * 2 * 100 + length) / (2 * length));
+        if (adjusted_index_topath > (length-1))
+            adjusted_index_topath = length-1;
+
+        qint64 delta;
+        if (i == 0)
+            delta = this->degrees_list.at(adjusted_index_topath) - this->begin_angle;
+        else
+            delta = this->degrees_list.at(adjusted_index_topath) - this->degrees_list.at(prev_adjusted_index_topath);
+
+        //A horizontal linear line has no begin angle to scale by
+        int skip_index = 0;
+        if (this->begin_angle > 0)
+            skip_index = (int)round_divide(delta, this->begin_angle);
+
+        skip_extend_index_list.append(skip_index);
+        prev_adjusted_index_topath = adjusted_index_topath;
+    }
+
+    return skip_extend_index_list;
+}
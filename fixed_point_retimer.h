@@ -0,0 +1,43 @@
+#ifndef FIXED_POINT_RETIMER_H
+#define FIXED_POINT_RETIMER_H
+
+#include <QtGlobal>
+#include <QList>
+#include <QVector>
+#include "bezier_points.h"
+
+/*
+ * Fixed point format used by Fixed_Point_Retimer is Q16.16 - ie 16 bits integer, 16 bits fraction
+ * FIXED_POINT_PERCENT_STEPS - number of points sampled along the Bezier Curve (0% to 99%). Same as the
+ *                             floating point path in Bezier_Curve::calculate_bezier_degrees
+ */
+#define FIXED_POINT_SHIFT 16
+#define FIXED_POINT_ONE (1 << FIXED_POINT_SHIFT)
+#define FIXED_POINT_PERCENT_STEPS 100
+
+typedef qint32 fixed_t;
+
+/*
+ * Fixed_Point_Retimer is the integer only equivalent of Bezier_Curve::calculate_bezier_degrees.
+ * Given the 4 Bezier points, it calculates the tangent degrees along the curve and the skip/extend index list
+ * for a number of Frames without any floating point. The results are bit-exact on every compiler and platform.
+ */
+class Fixed_Point_Retimer
+{
+public:
+    explicit Fixed_Point_Retimer(const Bezier_Points &points);
+    Bezier_Points points;
+    fixed_t begin_angle;
+    QVector<fixed_t>degrees_list;
+
+    void calculate_degrees();
+    QList<int> calculate_skip_extend_index_list(int frame_count);
+
+    static fixed_t atan_degrees(qint64 dy, qint64 dx);
+    static qreal to_qreal(fixed_t value);
+
+private:
+    void tangent_at_percent(int percent, qint64 *dx, qint64 *dy);
+};
+
+#endif // FIXED_POINT_RETIMER_H
@@ -1,22 +1,121 @@
 #include <QImage>
 #include <QPainter>
+#include <QPaintEvent>
+#include <QElapsedTimer>
+#include <QDir>
+#include <QCache>
+#include <QPair>
+#include "palette_storage.h"
 #include "frame.h"
 
+Resample_Quality Frame::display_quality = RESAMPLE_BALANCED;
+
+/*
+ * Images reduced to fit the view, keyed by the image (cacheKey) and the size and quality reduced to. Frames showing the
+ * same image share the entry. Accounted under MEMORY_CACHES
+ */
+typedef QPair<qint64, qint64> Display_Key;
+static QCache<Display_Key, QImage> display_cache(FRAME_DISPLAY_CACHE_BYTES);
+static qint64 display_cache_accounted_bytes = 0;
+
 Frame::Frame(QWidget *parent)
     : QWidget{parent}
 {
     hide();
-    index = 0;
-    src_index = 0;
-    delta = 0;
-    overwritten = false;
+    image = nullptr;
+    arena = nullptr;
+    memory_subsystem = MEMORY_DECODED_FRAMES;
+    accounted_bytes = 0;
+    telemetry = nullptr;
+}
+
+Frame::~Frame()
+{
+    Memory_Accounting::instance()->release(memory_subsystem, accounted_bytes);
+    delete image;
+}
+
+/*
+ * Account for the bytes held by this->image under this->memory_subsystem.
+ * Call whenever this->image is loaded or replaced.
+ */
+void Frame::update_memory_accounting()
+{
+    /*
+     * Retimed Frames sharing the pixels of an original Frame are accounted under the original Frame only.
+     * Pixels in this->arena are accounted by the arena
+     */
+    qint64 bytes = 0;
+    if (image && (memory_subsystem == MEMORY_DECODED_FRAMES || image->isDetached()))
+        bytes = image->sizeInBytes();
+    if (image && arena && arena->contains(image->constBits()))
+        bytes = 0;
+
+    if (bytes > accounted_bytes)
+        Memory_Accounting::instance()->add(memory_subsystem, bytes - accounted_bytes);
+    else if (bytes < accounted_bytes)
+        Memory_Accounting::instance()->release(memory_subsystem, accounted_bytes - bytes);
+    accounted_bytes = bytes;
+}
+
+/*
+ * this->image as shown - reduced to the size of the Frame if smaller, from the display cache, otherwise the image
+ * itself
+ */
+QImage Frame::display_image()
+{
+    if (!image || image->isNull() || image->size() == size())
+        return image ? *image : QImage();
+
+    Display_Key key(image->cacheKey(), ((qint64)width() << 32) | ((qint64)height() << 2) | display_quality);
+    if (QImage *cached = display_cache.object(key))
+        return *cached;
+
+    QImage fitted = Image_Resampler::resample(*image, size(), display_quality);
+    display_cache.insert(key, new QImage(fitted), fitted.sizeInBytes());
+
+    qint64 bytes = display_cache.totalCost();
+    if (bytes > display_cache_accounted_bytes)
+        Memory_Accounting::instance()->add(MEMORY_CACHES, bytes - display_cache_accounted_bytes);
+    else if (bytes < display_cache_accounted_bytes)
+        Memory_Accounting::instance()->release(MEMORY_CACHES, display_cache_accounted_bytes - bytes);
+    display_cache_accounted_bytes = bytes;
+    return fitted;
+}
+
+//Reduce the image to fit ahead of the Frame being shown, so the paint does not have to
+void Frame::prepare_display_image()
+{
+    display_image();
+}
+
+//Filename of the index-th .png of the animated sequence in directory, eg "3_0#.png"
+QString Frame::frame_filename(const QString &directory, int index)
+{
+    return QDir(directory).filePath("3_" + QString::number(index) + "#.png");
 }
 
 //Display the Frame image
 void Frame::paintEvent(QPaintEvent *event)
 {
+    QElapsedTimer paint_timer;
+    paint_timer.start();
+
+    //Only the region to repaint is drawn, not the whole frame
+    QRect exposed = event->rect();
     QPainter painter(this);
     painter.setPen(Qt::black);
     painter.drawRect(this->rect());
-    painter.drawImage(0, 0, *this->image);
+    if (this->image->size() != this->size() && !this->image->isNull())
+        painter.drawImage(exposed, display_image(), exposed);
+    else if (this->image->format() == QImage::Format_Indexed8){
+        //Expanded into a buffer reused by every Frame - only one Frame is painted at a time
+        static QImage display_buffer;
+        Palette_Storage::expand_for_display(*this->image, &display_buffer);
+        painter.drawImage(exposed, display_buffer, exposed);
+    } else
+        painter.drawImage(exposed, *this->image, exposed);
+
+    if (telemetry)
+        telemetry->record_paint(paint_timer.nsecsElapsed());
 }
@@ -4,22 +4,47 @@
 #include <QObject>
 #include <QWidget>
 #include <QImage>
+#include "memory_accounting.h"
+#include "playback_telemetry.h"
+#include "frame_arena.h"
+#include "image_resampler.h"
 
+/*
+ * FRAME_DIRECTORY           - known directory of the .png files of the animated sequence, see Frame::frame_filename
+ * FRAME_DISPLAY_CACHE_BYTES - images reduced to fit the view kept for painting, see Frame::display_image
+ */
+#define FRAME_DIRECTORY "C:/Users/Sean/VideoAd/interpolate_data/src/"
 #define NUMBER_FRAMES 142
 #define INTER_FRAME_INTERVAL_MSECS 35
+#define MEMORY_STATUS_INTERVAL_MSECS 1000
+#define LOOP_PREFETCH_FRAMES 4
+#define FRAME_DISPLAY_CACHE_BYTES (64 * 1024 * 1024)
 
+/*
+ * Frame displays one image of a Frames list. The timing metadata of the list (src_index, delta, ...) is kept apart in
+ * a Retime_Timeline, and the pixels may be held in a Frame_Arena shared by the whole list (see arena).
+ * A Frame smaller than its image (see MainWindow::layout_frames) shows the image reduced to fit, with display_quality.
+ */
 class Frame : public QWidget
 {
     Q_OBJECT
 
 public:
     explicit Frame(QWidget *parent = nullptr);
-    int index;
-    int src_index;
-    int delta;
-    bool overwritten;
+    ~Frame();
     QString filename;
     QImage *image;
+    const Frame_Arena *arena;
+    Memory_Subsystem memory_subsystem;
+    qint64 accounted_bytes;
+    Playback_Telemetry *telemetry;
+
+    static Resample_Quality display_quality;
+
+    void update_memory_accounting();
+    QImage display_image();
+    void prepare_display_image();
+    static QString frame_filename(const QString &directory, int index);
 
 signals:
 
@@ -0,0 +1,90 @@
+#include "frame_arena.h"
+#include "memory_accounting.h"
+#include "tile_grid.h"
+#ifdef Q_OS_LINUX
+#include <sys/mman.h>
+#endif
+
+//Round value up to a multiple of alignment (a power of 2)
+static inline qsizetype align_up(qsizetype value, qsizetype alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+/*
+ * Allocate the arena for frame_count frames. Every row and every frame starts on a FRAME_ARENA_ALIGNMENT boundary.
+ * is_valid() is false if the memory could not be allocated.
+ */
+Frame_Arena::Frame_Arena(int frame_count, const QSize &size, QImage::Format format)
+{
+    this->frame_count = qMax(0, frame_count);
+    this->size = size;
+    this->format = format;
+    int depth = QImage(1, 1, format).depth();
+    this->bytes_per_line = align_up(((qsizetype)size.width() * depth + 7) / 8, FRAME_ARENA_ALIGNMENT);
+    this->frame_bytes = align_up(bytes_per_line * size.height(), FRAME_ARENA_ALIGNMENT);
+    this->total_bytes = frame_bytes * this->frame_count;
+
+    qsizetype alignment = FRAME_ARENA_ALIGNMENT;
+    if (total_bytes >= FRAME_ARENA_HUGE_PAGE_BYTES){
+        alignment = FRAME_ARENA_HUGE_PAGE_BYTES;
+        total_bytes = align_up(total_bytes, FRAME_ARENA_HUGE_PAGE_BYTES);
+    }
+
+    memory = nullptr;
+    if (total_bytes > 0)
+        memory = (uchar *)qMallocAligned(total_bytes, alignment);
+    if (!memory){
+        total_bytes = 0;
+        return;
+    }
+
+#if defined(Q_OS_LINUX) && defined(MADV_HUGEPAGE)
+    if (alignment == FRAME_ARENA_HUGE_PAGE_BYTES)
+        madvise(memory, total_bytes, MADV_HUGEPAGE);
+#endif
+
+    Memory_Accounting::instance()->add(MEMORY_DECODED_FRAMES, total_bytes);
+}
+
+//Frees every frame at once. Images still using the arena must not be used afterwards
+Frame_Arena::~Frame_Arena()
+{
+    if (memory){
+        qFreeAligned(memory);
+        Memory_Accounting::instance()->release(MEMORY_DECODED_FRAMES, total_bytes);
+    }
+}
+
+bool Frame_Arena::is_valid() const
+{
+    return memory != nullptr;
+}
+
+//Whether bits (eg QImage::constBits()) point into the arena
+bool Frame_Arena::contains(const uchar *bits) const
+{
+    return memory && bits >= memory && bits < memory + total_bytes;
+}
+
+//Image using the arena's memory of frame index
+QImage Frame_Arena::frame_image(int index)
+{
+    if (!memory || index < 0 || index >= frame_count)
+        return QImage();
+    return QImage(memory + index * frame_bytes, size.width(), size.height(), bytes_per_line, format);
+}
+
+/*
+ * Copy image (converted to the arena's format) into frame index, tile by tile, and return the arena's image of it.
+ * An image of a different size cannot be stored and is returned as is.
+ */
+QImage Frame_Arena::store(int index, const QImage &image)
+{
+    QImage arena_image = frame_image(index);
+    if (arena_image.isNull() || image.size() != size)
+        return image;
+
+    Tile_Grid::copy_into(image.convertToFormat(format), &arena_image);
+    return arena_image;
+}
@@ -0,0 +1,47 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <QtGlobal>
+#include <QImage>
+#include <QSize>
+
+/*
+ * FRAME_ARENA_ALIGNMENT       - alignment of each frame (and each row) in the arena, a cache line / widest SIMD load
+ * FRAME_ARENA_HUGE_PAGE_BYTES - arenas of at least this size are aligned and sized to it so that the kernel can back
+ *                               them with huge pages
+ */
+#define FRAME_ARENA_ALIGNMENT 64
+#define FRAME_ARENA_HUGE_PAGE_BYTES (2 * 1024 * 1024)
+
+/*
+ * Frame_Arena holds the pixels of a whole sequence of frames of the same size and format in one contiguous, aligned
+ * allocation rather than one allocation per frame. The images handed out (see store, frame_image) use the arena's
+ * memory directly and do not own it - the arena must outlive them. The whole sequence is freed at once when the
+ * arena is deleted.
+ *
+ * The arena's bytes are accounted under MEMORY_DECODED_FRAMES for as long as it exists.
+ */
+class Frame_Arena
+{
+public:
+    Frame_Arena(int frame_count, const QSize &size, QImage::Format format);
+    ~Frame_Arena();
+
+    int frame_count;
+    QSize size;
+    QImage::Format format;
+    qsizetype bytes_per_line;
+    qsizetype frame_bytes;
+    qsizetype total_bytes;
+
+    bool is_valid() const;
+    bool contains(const uchar *bits) const;
+    QImage frame_image(int index);
+    QImage store(int index, const QImage &image);
+
+private:
+    uchar *memory;
+    Q_DISABLE_COPY(Frame_Arena)
+};
+
+#endif // FRAME_ARENA_H
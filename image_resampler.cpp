@@ -0,0 +1,187 @@
+#include <QtConcurrent>
+#include <QtMath>
+#include <QVarLengthArray>
+#include "image_resampler.h"
+#include "simd_kernels.h"
+
+/*
+ * Filter_Weights of one direction of a resample - for each output pixel, the first of the taps input pixels it is
+ * made from (offsets) and their weights (taps per output pixel)
+ */
+struct Filter_Weights
+{
+    int taps;
+    QVector<int> offsets;
+    QVector<qint16> weights;
+};
+
+static qreal filter_radius(Resample_Quality quality)
+{
+    switch (quality){
+        case RESAMPLE_FAST:
+            return 0.5;
+        case RESAMPLE_BEST:
+            return 3.0;
+        default:
+            break;
+    }
+    return 1.0;
+}
+
+static qreal filter_value(Resample_Quality quality, qreal x)
+{
+    x = qAbs(x);
+    switch (quality){
+        case RESAMPLE_FAST:
+            return x < 0.5 ? 1.0 : 0.0;
+        case RESAMPLE_BEST:
+            if (x < 1e-9)
+                return 1.0;
+            if (x >= 3.0)
+                return 0.0;
+            return (3.0 * qSin(M_PI * x) * qSin(M_PI * x / 3.0)) / (M_PI * M_PI * x * x);
+        default:
+            break;
+    }
+    return qMax(0.0, 1.0 - x);
+}
+
+/*
+ * Weights to resample src_length pixels to dst_length. When reducing, the filter is widened by the reduction so that
+ * every input pixel contributes. Taps falling off the edge are given to the edge pixel, and each output pixel's window
+ * is moved to lie within the input so the kernels never read outside it.
+ */
+static Filter_Weights filter_weights(int src_length, int dst_length, Resample_Quality quality)
+{
+    qreal scale = (qreal)src_length / dst_length;
+    qreal filter_scale = qMax(1.0, scale);
+    qreal support = filter_radius(quality) * filter_scale;
+
+    Filter_Weights filter;
+    filter.taps = qMin(src_length, (int)qCeil(support) * 2 + 1);
+    filter.offsets.resize(dst_length);
+    filter.weights.resize(dst_length * filter.taps);
+
+    QVector<qreal>weights(filter.taps);
+    for (int i=0; i < dst_length; i++){
+        qreal center = (i + 0.5) * scale;
+        int start = qFloor(center - support);
+        int offset = qBound(0, start, src_length - filter.taps);
+        weights.fill(0.0);
+
+        qreal total = 0.0;
+        for (int j=start; j <= qCeil(center + support); j++){
+            qreal weight = filter_value(quality, (j + 0.5 - center) / filter_scale);
+            if (weight == 0.0)
+                continue;
+            int tap = qBound(0, j, src_length - 1) - offset;
+            if (tap < 0 || tap >= filter.taps)
+                continue;
+            weights[tap] += weight;
+            total += weight;
+        }
+        //Nothing covered (a box between pixels) - take the nearest pixel
+        if (total == 0.0){
+            weights[qBound(0, (int)center - offset, filter.taps - 1)] = 1.0;
+            total = 1.0;
+        }
+
+        //To fixed point summing exactly to 1 << RESAMPLE_WEIGHT_BITS - the remainder goes to the largest weight
+        int fixed_total = 0, largest = 0;
+        qint16 *fixed = filter.weights.data() + i * filter.taps;
+        for (int k=0; k < filter.taps; k++){
+            fixed[k] = (qint16)qRound(weights.at(k) / total * (1 << RESAMPLE_WEIGHT_BITS));
+            fixed_total += fixed[k];
+            if (qAbs(fixed[k]) > qAbs(fixed[largest]))
+                largest = k;
+        }
+        fixed[largest] += (1 << RESAMPLE_WEIGHT_BITS) - fixed_total;
+        filter.offsets[i] = offset;
+    }
+    return filter;
+}
+
+struct Resample_Band
+{
+    int first_row;
+    int last_row;
+};
+
+//Resample image to size (any aspect ratio)
+QImage Image_Resampler::resample(const QImage &image, const QSize &size, Resample_Quality quality)
+{
+    if (image.isNull() || size.isEmpty())
+        return QImage();
+    QImage::Format format = image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+    QImage src = image.convertToFormat(format);
+    if (src.size() == size)
+        return src;
+
+    Filter_Weights horizontal = filter_weights(src.width(), size.width(), quality);
+    Filter_Weights vertical = filter_weights(src.height(), size.height(), quality);
+
+    //Rows first, at the input height, then columns
+    QImage rows(size.width(), src.height(), format);
+    QImage dst(size, format);
+    if (rows.isNull() || dst.isNull())
+        return QImage();
+
+    QVector<Resample_Band>row_bands, dst_bands;
+    for (int y=0; y < src.height(); y += RESAMPLE_BAND_ROWS)
+        row_bands.append({y, qMin(src.height(), y + RESAMPLE_BAND_ROWS) - 1});
+    for (int y=0; y < size.height(); y += RESAMPLE_BAND_ROWS)
+        dst_bands.append({y, qMin(size.height(), y + RESAMPLE_BAND_ROWS) - 1});
+
+    QtConcurrent::blockingMap(row_bands, [&src, &rows, &horizontal](const Resample_Band &band) {
+        for (int y=band.first_row; y <= band.last_row; y++)
+            resample_horizontal((const QRgb *)src.constScanLine(y), (QRgb *)rows.scanLine(y), rows.width(),
+                                horizontal.offsets.constData(), horizontal.weights.constData(), horizontal.taps);
+    });
+
+    const QImage &const_rows = rows;
+    QtConcurrent::blockingMap(dst_bands, [&const_rows, &dst, &vertical](const Resample_Band &band) {
+        QVarLengthArray<const uchar *, 64>row_pointers(vertical.taps);
+        for (int y=band.first_row; y <= band.last_row; y++){
+            for (int k=0; k < vertical.taps; k++)
+                row_pointers[k] = const_rows.constScanLine(vertical.offsets.at(y) + k);
+            resample_vertical(row_pointers.constData(), vertical.weights.constData() + y * vertical.taps, vertical.taps,
+                              dst.scanLine(y), (qsizetype)dst.width() * 4);
+        }
+    });
+
+    //Negative lobes can leave a colour above its alpha, which is invalid premultiplied
+    if (format == QImage::Format_ARGB32_Premultiplied && quality == RESAMPLE_BEST){
+        for (int y=0; y < dst.height(); y++){
+            QRgb *pixels = (QRgb *)dst.scanLine(y);
+            for (int x=0; x < dst.width(); x++){
+                int alpha = qAlpha(pixels[x]);
+                pixels[x] = qRgba(qMin(qRed(pixels[x]), alpha), qMin(qGreen(pixels[x]), alpha),
+                                  qMin(qBlue(pixels[x]), alpha), alpha);
+            }
+        }
+    }
+    return dst;
+}
+
+//image reduced to width, keeping its aspect ratio. Images already no wider are returned as they are
+QImage Image_Resampler::reduce_to_width(const QImage &image, int width, Resample_Quality quality)
+{
+    if (width <= 0 || image.width() <= width)
+        return image;
+    return resample(image, QSize(width, qMax(1, qRound((qreal)image.height() * width / image.width()))), quality);
+}
+
+//Names of the quality presets, in Resample_Quality order
+QStringList Image_Resampler::quality_names()
+{
+    return {"fast", "balanced", "best"};
+}
+
+bool Image_Resampler::parse_quality(const QString &name, Resample_Quality *quality)
+{
+    int index = quality_names().indexOf(name.trimmed().toLower());
+    if (index < 0)
+        return false;
+    *quality = (Resample_Quality)index;
+    return true;
+}
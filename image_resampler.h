@@ -0,0 +1,44 @@
+#ifndef IMAGE_RESAMPLER_H
+#define IMAGE_RESAMPLER_H
+
+#include <QtGlobal>
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/*
+ * RESAMPLE_BAND_ROWS - rows resampled per job. Bands of rows are resampled on all cores
+ */
+#define RESAMPLE_BAND_ROWS 32
+
+/*
+ * Resample_Quality presets, fastest first
+ *   RESAMPLE_FAST     - box filter, ie the average of the pixels covered. Nearest pixel when enlarging
+ *   RESAMPLE_BALANCED - bilinear (triangle) filter, widened when reducing so that no pixel is skipped
+ *   RESAMPLE_BEST     - Lanczos-3 filter, the sharpest, at 3 times the cost of bilinear
+ */
+enum Resample_Quality {
+    RESAMPLE_FAST = 0,
+    RESAMPLE_BALANCED,
+    RESAMPLE_BEST
+};
+
+/*
+ * Image_Resampler scales images with a separable filter - rows first (resample_horizontal), then columns
+ * (resample_vertical), both vectorized kernels with fixed point weights precalculated once per image. Bands of rows
+ * are resampled in parallel. Used to reduce frames on ingest and to fit frames to the view.
+ *
+ * Images are resampled as premultiplied ARGB32 (RGB32 if opaque), which is also the format returned.
+ */
+class Image_Resampler
+{
+public:
+    static QImage resample(const QImage &image, const QSize &size, Resample_Quality quality);
+    static QImage reduce_to_width(const QImage &image, int width, Resample_Quality quality);
+    static bool parse_quality(const QString &name, Resample_Quality *quality);
+    static QStringList quality_names();
+};
+
+#endif // IMAGE_RESAMPLER_H
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include "keyframe_timeline.h"
+
+Keyframe_Timeline::Keyframe_Timeline()
+{
+}
+
+//Insert a keyframe in frame order. A keyframe at an existing frame replaces it
+void Keyframe_Timeline::add_keyframe(int frame, int src_frame, const Easing_Table &easing)
+{
+    int position = std::lower_bound(frames.begin(), frames.end(), frame) - frames.begin();
+    if (position < frames.length() && frames.at(position) == frame){
+        src_frames[position] = src_frame;
+        easings[position] = easing;
+        return;
+    }
+
+    frames.insert(position, frame);
+    src_frames.insert(position, src_frame);
+    easings.insert(position, easing);
+}
+
+void Keyframe_Timeline::clear()
+{
+    frames.clear();
+    src_frames.clear();
+    easings.clear();
+}
+
+/*
+ * Segment (index of its first keyframe) which frame falls in. Frames before the first keyframe are in segment 0, frames
+ * from the last keyframe on are in the last keyframe's segment.
+ */
+int Keyframe_Timeline::segment_at(int frame) const
+{
+    int segment = std::upper_bound(frames.begin(), frames.end(), frame) - frames.begin() - 1;
+    return qBound(0, segment, frames.length()-1);
+}
+
+//Source position (fractional source frame) at frame within segment
+qreal Keyframe_Timeline::segment_position(int segment, int frame) const
+{
+    if (segment >= frames.length()-1)
+        return src_frames.at(segment);
+
+    int frame_begin = frames.at(segment);
+    int frame_end = frames.at(segment+1);
+    qreal x = (qreal)(frame - frame_begin) / (frame_end - frame_begin);
+    qreal progress = easings.at(segment).ease(qBound(0.0, x, 1.0));
+
+    return src_frames.at(segment) + (src_frames.at(segment+1) - src_frames.at(segment)) * progress;
+}
+
+//Source position (fractional source frame) shown at frame
+qreal Keyframe_Timeline::source_position(int frame) const
+{
+    if (frames.isEmpty())
+        return frame;
+    return segment_position(segment_at(frame), frame);
+}
+
+/*
+ * The source frame to show at each of frame_count output frames, within 0 to src_frame_count-1.
+ * The segment is advanced as the frames are walked rather than looked up for every frame.
+ */
+QVector<int> Keyframe_Timeline::retime(int frame_count, int src_frame_count) const
+{
+    QVector<int>content_map(frame_count);
+    if (frame_count == 0)
+        return content_map;
+
+    int segment = segment_at(0);
+    for (int frame=0; frame < frame_count; frame++){
+        qreal position = frame;
+        if (!frames.isEmpty()){
+            while (segment < frames.length()-1 && frame >= frames.at(segment+1))
+                segment++;
+            position = segment_position(segment, frame);
+        }
+        content_map[frame] = qBound(0, qRound(position), src_frame_count-1);
+    }
+    return content_map;
+}
+
+/*
+ * Load from JSON, eg
+ *   {"keyframes": [{"frame": 0, "src_frame": 0, "easing": [0.42, 0, 1, 1]}, ...]}
+ * easing is the segment's [x1, y1, x2, y2], linear when not given.
+ */
+bool Keyframe_Timeline::load(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll());
+    if (!document.isObject())
+        return false;
+
+    clear();
+    QJsonArray keyframes_array = document.object().value("keyframes").toArray();
+    for (int i=0; i < keyframes_array.size(); i++){
+        QJsonObject keyframe_object = keyframes_array.at(i).toObject();
+        Easing_Table easing;
+        QJsonArray easing_array = keyframe_object.value("easing").toArray();
+        if (easing_array.size() == 4)
+            easing = Easing_Table(easing_array.at(0).toDouble(), easing_array.at(1).toDouble(),
+                                  easing_array.at(2).toDouble(), easing_array.at(3).toDouble());
+        add_keyframe(keyframe_object.value("frame").toInt(), keyframe_object.value("src_frame").toInt(), easing);
+    }
+    return !frames.isEmpty();
+}
+
+bool Keyframe_Timeline::save(const QString &filename) const
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    file.write(QJsonDocument(to_json()).toJson());
+    return true;
+}
+
+//The keyframes as the JSON object read by load
+QJsonObject Keyframe_Timeline::to_json() const
+{
+    QJsonArray keyframes_array;
+    for (int i=0; i < frames.length(); i++){
+        const Easing_Table &easing = easings.at(i);
+        QJsonObject keyframe_object;
+        keyframe_object["frame"] = frames.at(i);
+        keyframe_object["src_frame"] = src_frames.at(i);
+        keyframe_object["easing"] = QJsonArray({easing.x1, easing.y1, easing.x2, easing.y2});
+        keyframes_array.append(keyframe_object);
+    }
+
+    QJsonObject root_object;
+    root_object["keyframes"] = keyframes_array;
+    return root_object;
+}
+
+/*
+ * Example timeline over frame_count frames - ease into the middle of the sequence, hold there, then ease out to the end
+ */
+Keyframe_Timeline Keyframe_Timeline::ease_hold_ease(int frame_count)
+{
+    Keyframe_Timeline timeline;
+    int last = frame_count - 1;
+    int hold_begin = last * 2 / 5;
+    int hold_end = last * 3 / 5;
+
+    timeline.add_keyframe(0, 0, Easing_Table(0.42, 0.0, 1.0, 1.0));
+    timeline.add_keyframe(hold_begin, last / 2, Easing_Table());
+    timeline.add_keyframe(hold_end, last / 2, Easing_Table(0.0, 0.0, 0.58, 1.0));
+    timeline.add_keyframe(last, last, Easing_Table());
+    return timeline;
+}
@@ -0,0 +1,47 @@
+#ifndef KEYFRAME_TIMELINE_H
+#define KEYFRAME_TIMELINE_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QJsonObject>
+#include <QVector>
+#include "easing_table.h"
+
+/*
+ * Keyframe_Timeline is a list of keyframes, each mapping an output frame to a source frame. Between two keyframes is a
+ * segment, whose source frames are eased according to the Easing_Table of its first keyframe. A segment whose two
+ * keyframes have the same source frame holds that frame.
+ *   eg ease into a pause, hold, then ease out again
+ *      frame 0   -> source 0   ease-in
+ *      frame 60  -> source 70  hold
+ *      frame 80  -> source 70  ease-out
+ *      frame 141 -> source 141
+ *
+ * Keyframes are kept sorted by frame in separate arrays. Looking up the segment of a frame is a binary search, and
+ * retime() walks the segments in step with the frames so a whole sequence is retimed in linear time.
+ */
+class Keyframe_Timeline
+{
+public:
+    Keyframe_Timeline();
+
+    QVector<int>frames;
+    QVector<int>src_frames;
+    QVector<Easing_Table>easings;
+
+    void add_keyframe(int frame, int src_frame, const Easing_Table &easing);
+    void clear();
+    int segment_at(int frame) const;
+    qreal source_position(int frame) const;
+    QVector<int> retime(int frame_count, int src_frame_count) const;
+
+    bool load(const QString &filename);
+    bool save(const QString &filename) const;
+    QJsonObject to_json() const;
+    static Keyframe_Timeline ease_hold_ease(int frame_count);
+
+private:
+    qreal segment_position(int segment, int frame) const;
+};
+
+#endif // KEYFRAME_TIMELINE_H
@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <QtConcurrent>
+#include "loop_analysis.h"
+#include "simd_kernels.h"
+#include "tile_grid.h"
+
+//2 frames to compare for a candidate's score
+struct Loop_Candidate
+{
+    Loop_Points points;
+    int frame_a;
+    int frame_b;
+};
+
+/*
+ * Returns up to count candidates, most seamless first
+ */
+QVector<Loop_Points> Loop_Analysis::find_loop_points(const QVector<QImage> &frames, int count)
+{
+    QVector<Loop_Points>loop_points;
+    int frame_count = frames.length();
+    if (frame_count < 2)
+        return loop_points;
+
+    int min_length = qMax(2, frame_count * LOOP_MIN_LENGTH_PERCENT / 100);
+
+    //Enumerate candidates with the 2 frames which score them
+    QVector<Loop_Candidate>candidates;
+    for (int loop_start=0; loop_start < qMin(LOOP_SEARCH_WINDOW, frame_count); loop_start++){
+        for (int loop_end=qMax(0, frame_count - LOOP_SEARCH_WINDOW); loop_end < frame_count; loop_end++){
+            if (loop_end - loop_start + 1 < min_length)
+                continue;
+
+            Loop_Candidate candidate;
+            candidate.points = {loop_start, loop_end, 0.0};
+            if (loop_end + 1 < frame_count){
+                candidate.frame_a = loop_end + 1;
+                candidate.frame_b = loop_start;
+            } else if (loop_start > 0){
+                candidate.frame_a = loop_end;
+                candidate.frame_b = loop_start - 1;
+            } else
+                continue;
+            candidates.append(candidate);
+        }
+    }
+
+    //Score all candidates in parallel - one at a time tile by tile for large frames
+    if (Tile_Grid::use_tiles(frames.first().size())){
+        for (int i=0; i < candidates.length(); i++)
+            candidates[i].points.score = Tile_Grid::image_difference(frames.at(candidates.at(i).frame_a),
+                                                                     frames.at(candidates.at(i).frame_b));
+    } else {
+        QtConcurrent::blockingMap(candidates, [&frames](Loop_Candidate &candidate) {
+            candidate.points.score = image_difference(frames.at(candidate.frame_a), frames.at(candidate.frame_b));
+        });
+    }
+
+    for (int i=0; i < candidates.length(); i++){
+        if (candidates.at(i).points.score >= 0)
+            loop_points.append(candidates.at(i).points);
+    }
+
+    //Most seamless first, longer loops first on equal scores
+    std::stable_sort(loop_points.begin(), loop_points.end(), [](const Loop_Points &a, const Loop_Points &b) {
+        if (a.score != b.score)
+            return a.score < b.score;
+        return (a.loop_end - a.loop_start) > (b.loop_end - b.loop_start);
+    });
+    if (loop_points.length() > count)
+        loop_points.resize(count);
+
+    return loop_points;
+}
@@ -0,0 +1,39 @@
+#ifndef LOOP_ANALYSIS_H
+#define LOOP_ANALYSIS_H
+
+#include <QtGlobal>
+#include <QImage>
+#include <QVector>
+
+/*
+ * LOOP_SEARCH_WINDOW      - loop start is searched within the first, loop end within the last LOOP_SEARCH_WINDOW frames
+ * LOOP_MIN_LENGTH_PERCENT - a loop covers at least this percentage of the sequence
+ */
+#define LOOP_SEARCH_WINDOW 30
+#define LOOP_MIN_LENGTH_PERCENT 50
+
+/*
+ * A candidate loop from loop_start to loop_end (inclusive). score is the mean absolute difference per channel (0-255)
+ * at the wrap - lower is more seamless.
+ */
+struct Loop_Points
+{
+    int loop_start;
+    int loop_end;
+    qreal score;
+};
+
+/*
+ * Loop_Analysis finds the loop points of a sequence which wrap with the least visible hitch.
+ * Wrapping from loop_end back to loop_start is seamless when loop_start looks like the frame that would naturally follow
+ * loop_end, so each candidate is scored by the difference of frame loop_end+1 and frame loop_start (or of frame loop_end
+ * and frame loop_start-1 when loop_end is the last frame). The frame differences are calculated in parallel with the
+ * vectorized image_difference kernel.
+ */
+class Loop_Analysis
+{
+public:
+    static QVector<Loop_Points> find_loop_points(const QVector<QImage> &frames, int count = 5);
+};
+
+#endif // LOOP_ANALYSIS_H
@@ -1,11 +1,294 @@
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QScopedPointer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QDebug>
+#include "bezier_curve.h"
+#include "easing_policy.h"
+#include "stream_writer.h"
+#include "motion_blur.h"
+#include "retime_daemon.h"
+#include "motion_analysis.h"
+#include "smoothness_score.h"
+#include "curve_extraction.h"
+#include "sprite_atlas.h"
+#include "image_resampler.h"
+#ifdef Q_OS_WIN
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+//Options which run without the window - the application is then created without a GUI so no display is needed
+static const char *headless_options[] = {"--stream", "--daemon", "--score", "--extract", "--atlas"};
+
+static bool is_headless(int argc, char *argv[])
+{
+    for (int i=1; i < argc; i++){
+        QByteArray argument(argv[i]);
+        for (const char *option : headless_options){
+            if (argument == option || argument.startsWith(QByteArray(option) + "="))
+                return true;
+        }
+    }
+    return false;
+}
+
+//Width the frames are reduced to as they are read (--ingest-width), 0 for full size, and the quality (--quality)
+static int ingest_width = 0;
+static Resample_Quality resample_quality = RESAMPLE_BALANCED;
+
+//Read the animated sequence from directory (see Frame::frame_filename). Returns false if any .png cannot be read
+static bool load_frames(const QString &directory, QVector<QImage> *images)
+{
+    for (int i=0; i < NUMBER_FRAMES; i++){
+        QImage image(Frame::frame_filename(directory, i));
+        if (image.isNull()){
+            qWarning().noquote() << "Unable to read" << Frame::frame_filename(directory, i);
+            return false;
+        }
+        images->append(Image_Resampler::reduce_to_width(image, ingest_width, resample_quality));
+    }
+    return true;
+}
+
+/*
+ * Content map of the retimed sequence - the named easing (see Easing_Function::from_name) if given, otherwise the
+ * selected Bezier Curve. The Bezier Curve is retimed on the fixed point path, which needs no begin angle from the
+ * Bezier Curve Window.
+ */
+static bool retimed_content_map(const QCommandLineParser &parser, int frame_count, QVector<int> *content_map)
+{
+    if (parser.isSet("easing")){
+        bool ok;
+        Easing_Function easing = Easing_Function::from_name(parser.value("easing"), &ok);
+        if (!ok){
+            qWarning().noquote() << "Unknown easing" << parser.value("easing");
+            return false;
+        }
+        *content_map = retime_with_easing(easing, frame_count, frame_count);
+    } else
+        *content_map = Bezier_Curve::compute_content_map(Bezier_Curve::selected_bezier_points(), true, 0.0, frame_count);
+    return true;
+}
+
+/*
+ * The original frames and the content map of the retimed sequence - from the running daemon with --from-daemon (client
+ * must then outlive images), otherwise read from --frames
+ */
+static bool load_retimed_sequence(const QCommandLineParser &parser, Retime_Client *client, QVector<QImage> *images,
+                                  QVector<int> *content_map)
+{
+    //With --from-daemon the frames are read straight out of the daemon's shared memory, and it does the retiming
+    if (parser.isSet("from-daemon")){
+        if (!client->connect_to_daemon() || !client->open_sequence(parser.value("frames"))
+                || !client->retime(parser.value("easing"), content_map)){
+            qWarning().noquote() << client->error;
+            return false;
+        }
+        for (int i=0; i < client->frame_count; i++)
+            images->append(client->frame(i));
+        return true;
+    }
+
+    if (!load_frames(parser.value("frames"), images))
+        return false;
+    return retimed_content_map(parser, images->length(), content_map);
+}
+
+//Open the --output file, or stdout for "-"
+static bool open_output(const QCommandLineParser &parser, QFile *output)
+{
+    QString output_name = parser.value("output");
+    bool opened;
+    if (output_name == "-"){
+#ifdef Q_OS_WIN
+        //stdout is in text mode by default, which would mangle the binary frames
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        opened = output->open(stdout, QIODevice::WriteOnly);
+    } else {
+        output->setFileName(output_name);
+        opened = output->open(QIODevice::WriteOnly);
+    }
+    if (!opened)
+        qWarning().noquote() << "Unable to write" << output_name;
+    return opened;
+}
+
+/*
+ * Write the retimed sequence in order to the output (stdout by default) in the stream format, eg
+ *     test_interpolate --stream y4m | ffmpeg -i - out.mp4
+ */
+static int run_stream(const QCommandLineParser &parser)
+{
+    Stream_Format format;
+    if (!Stream_Writer::parse_format(parser.value("stream"), &format)){
+        qWarning().noquote() << "Unknown stream format" << parser.value("stream") << "- expected y4m or rgba";
+        return 1;
+    }
+
+    Retime_Client client;
+    QVector<QImage>images;
+    QVector<int>content_map;
+    if (!load_retimed_sequence(parser, &client, &images, &content_map))
+        return 1;
+
+    QFile output;
+    if (!open_output(parser, &output))
+        return 1;
+
+    Retime_Timeline timeline = timeline_from_content_map(content_map);
+    bool motion_blur = parser.isSet("motion-blur");
+    Stream_Writer writer(&output, format, parser.value("fps").toInt());
+    for (int i=0; i < timeline.length(); i++){
+        QImage image = motion_blur ? Motion_Blur::blurred_slot(timeline, i, images) : images.at(timeline.content_index.at(i));
+        if (!writer.write_frame(image)){
+            qWarning() << "Stream ended at frame" << i;
+            return 1;
+        }
+    }
+    output.flush();
+    return 0;
+}
+
+/*
+ * Write the Smoothness_Report of the retimed sequence as JSON to the output (stdout by default). With --max-score, exits
+ * with 2 if the score is above it, so that a pipeline can reject the curve, eg
+ *     test_interpolate --score --easing ease-in-out-cubic --max-score 1.5
+ */
+static int run_score(const QCommandLineParser &parser)
+{
+    Retime_Client client;
+    QVector<QImage>images;
+    QVector<int>content_map;
+    if (!load_retimed_sequence(parser, &client, &images, &content_map))
+        return 1;
+
+    Smoothness_Report report = Smoothness_Scorer::score(content_map, Motion_Analysis::motion_energy(images));
+
+    QFile output;
+    if (!open_output(parser, &output))
+        return 1;
+    output.write(QJsonDocument(report.to_json()).toJson());
+    output.flush();
+
+    if (parser.isSet("max-score") && report.score > parser.value("max-score").toDouble()){
+        qWarning().noquote() << "Score" << report.score << "is above" << parser.value("max-score");
+        return 2;
+    }
+    return 0;
+}
+
+/*
+ * Write the curve extracted from the reference animation in directory --extract, relative to --frames, as JSON to the
+ * output. Its "easing" can be given to --easing and its "keyframes" saved as a Keyframe Timeline
+ */
+static int run_extract(const QCommandLineParser &parser)
+{
+    QVector<QImage>source;
+    if (!load_frames(parser.value("frames"), &source))
+        return 1;
+    QVector<QImage>reference = Curve_Extraction::read_sequence(parser.value("extract"));
+    if (reference.isEmpty()){
+        qWarning().noquote() << "No reference frames read from" << parser.value("extract");
+        return 1;
+    }
+
+    Extracted_Curve curve = Curve_Extraction::extract(source, reference);
+    QFile output;
+    if (!open_output(parser, &output))
+        return 1;
+    output.write(QJsonDocument(curve.to_json()).toJson());
+    output.flush();
+    return 0;
+}
+
+/*
+ * Write the retimed sequence as a Sprite_Atlas - <base>_<page>.png, <base>.json and <base>.atlas - eg
+ *     test_interpolate --atlas out/clock --easing ease-in-out-cubic
+ */
+static int run_atlas(const QCommandLineParser &parser)
+{
+    Retime_Client client;
+    QVector<QImage>images;
+    QVector<int>content_map;
+    if (!load_retimed_sequence(parser, &client, &images, &content_map))
+        return 1;
+
+    Retime_Timeline timeline = timeline_from_content_map(content_map);
+    QVector<QImage>slot_images;
+    for (int i=0; i < timeline.length(); i++){
+        if (parser.isSet("motion-blur"))
+            slot_images.append(Motion_Blur::blurred_slot(timeline, i, images));
+        else
+            slot_images.append(images.at(timeline.content_index.at(i)));
+    }
+
+    Sprite_Atlas atlas;
+    atlas.build(slot_images);
+    if (!atlas.save(parser.value("atlas"), parser.value("fps").toInt())){
+        qWarning().noquote() << "Unable to write the sprite atlas" << parser.value("atlas");
+        return 1;
+    }
+    return 0;
+}
 
 int main(int argc, char *argv[])
 {
-    QApplication a(argc, argv);
-    MainWindow w;
+    QScopedPointer<QCoreApplication> a(is_headless(argc, argv) ? new QCoreApplication(argc, argv) : new QApplication(argc, argv));
+    QCoreApplication::setApplicationName("bezier_easeinout");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Ease-In/Ease-Out retiming of an animated sequence of .png files");
+    parser.addHelpOption();
+    parser.addOption({"stream", "Write the retimed sequence as <format> (y4m or rgba) instead of showing the window.",
+                      "format"});
+    parser.addOption({{"o", "output"}, "Output file of --stream, --score or --extract, - for stdout.", "file", "-"});
+    parser.addOption({"fps", "Frame rate of --stream or --atlas.", "fps", QString::number(1000 / INTER_FRAME_INTERVAL_MSECS)});
+    parser.addOption({"frames", "Directory of the .png files retimed by the command line options.", "directory", FRAME_DIRECTORY});
+    parser.addOption({"easing", "Retime with a named easing (eg ease-in-out-cubic, cubic-bezier(x1,y1,x2,y2)) "
+                      "rather than the Bezier Curve.", "name"});
+    parser.addOption({"motion-blur", "Blend the frames skipped over into each frame of --stream or --atlas."});
+    parser.addOption({"daemon", "Keep sequences resident and serve retiming requests to other processes (see Retime_Daemon)."});
+    parser.addOption({"from-daemon", "Take the frames and retiming from a running --daemon."});
+    parser.addOption({"score", "Write the smoothness metrics of the retimed sequence as JSON instead of showing the window."});
+    parser.addOption({"max-score", "With --score, exit with 2 if the score is above <score>.", "score"});
+    parser.addOption({"atlas", "Write the retimed sequence as a sprite atlas <base>_<page>.png, <base>.json and "
+                      "<base>.atlas instead of showing the window.", "base"});
+    parser.addOption({"extract", "Write the easing curve of the reference animation in <directory> relative to --frames as "
+                      "JSON instead of showing the window.", "directory"});
+    parser.addOption({"ingest-width", "Reduce the frames to at most <pixels> wide as they are read.", "pixels", "0"});
+    parser.addOption({"quality", "Quality of resampling the frames (" + Image_Resampler::quality_names().join(", ") + ").",
+                      "quality", "balanced"});
+    parser.process(*a);
+
+    ingest_width = parser.value("ingest-width").toInt();
+    if (!Image_Resampler::parse_quality(parser.value("quality"), &resample_quality)){
+        qWarning().noquote() << "Unknown quality" << parser.value("quality") << "- expected"
+                             << Image_Resampler::quality_names().join(", ");
+        return 1;
+    }
+
+    if (parser.isSet("daemon")){
+        Retime_Daemon daemon;
+        if (!daemon.listen())
+            return 1;
+        return a->exec();
+    }
+    if (parser.isSet("stream"))
+        return run_stream(parser);
+    if (parser.isSet("score"))
+        return run_score(parser);
+    if (parser.isSet("extract"))
+        return run_extract(parser);
+    if (parser.isSet("atlas"))
+        return run_atlas(parser);
+
+    MainWindow w(ingest_width, resample_quality);
     w.show();
-    return a.exec();
+    return a->exec();
 }
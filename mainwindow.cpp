@@ -4,6 +4,34 @@
 #include <QDebug>
 #include <QSlider>
 #include <QRect>
+#include <QFileDialog>
+#include <QStatusBar>
+#include <QMenuBar>
+#include <QKeySequence>
+#include <QFileInfo>
+#include <QDir>
+#include <QMessageBox>
+#include <QResizeEvent>
+#include <QSet>
+#include <QtConcurrent>
+#include "memory_accounting.h"
+#include "retime_cache.h"
+#include "loop_analysis.h"
+#include "palette_storage.h"
+#include "curve_sweep.h"
+#include "motion_analysis.h"
+#include "easing_policy.h"
+#include "motion_blur.h"
+#include "smoothness_score.h"
+#include "curve_extraction.h"
+#include "sprite_atlas.h"
+#include "image_resampler.h"
+#include "source_watcher.h"
+#include <QInputDialog>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QActionGroup>
+#include <QApplication>
 #include "frame.h"
 
 /*
@@ -60,15 +88,107 @@
  *      List of Frames instances for a modified animation per bezier curve shape
  *      This list starts off being identical to frames_list at the outset
  *
+ *    new_timeline
+ *      Retime_Timeline of frames_new_list - the original Frame shown at each index and how it got there. Kept as
+ *      arrays apart from the Frames, which only display
+ *
+ *    Frame_Arena
+ *      The pixels of frame_list are held in one aligned allocation (frame_arena) which frames_new_list shares,
+ *      freed as a unit on exit
+ *
  *    timer
  *      - timer which fires to advance the frames in the MainWIndow - it drives the animation
  *      INTER_FRAME_INTERVAL_MSECS specifies the time interval in msecs between each Frame animation
  *
+ *    Timeline_History
+ *      Every deploy is pushed as a snapshot of new_timeline, which Tools > Undo Deploy / Redo Deploy step through
+ *      without recomputing or re-decoding anything. Tools > Compare Deploy History plays them in the Variant_Grid
+ *
+ *    Deploy_Worker
+ *      "Deploy Bezier Curve" runs on a worker thread, building the new timeline from frame_list into a back buffer.
+ *      Playback carries on meanwhile and the back buffer is swapped into frame_new_list in one go when complete.
+ *      Progress and Cancel are shown in the status bar
+ *
+ *    Motion_Blur
+ *      With Tools > Motion Blur on Skips checked, the next deploy blends the original Frames skipped over by each
+ *      skip (eg +19) into the frame shown, instead of jumping straight to it
+ *
+ *    Keyframe_Timeline
+ *      Multi-segment timeline of keyframes, each segment with its own easing (eg ease-in, hold, ease-out). Deployed from
+ *      a JSON file or as an example from the Tools menu instead of the single Bezier Curve
+ *
+ *    Easing policies
+ *      Easing curves besides the Bezier Curve are types with an ease() function (see easing_policy.h), inlined into
+ *      retime_with_easing. Tools > Deploy Named Easing picks one by name at runtime through Easing_Function
+ *
+ *    Curve_Extraction
+ *      Tools > Extract Curve from Reference matches the frames of an eased reference animation to frame_list and fits a
+ *      cubic-bezier and a Keyframe_Timeline to the timing, so an existing feel can be deployed rather than guessed
+ *
+ *    Motion_Analysis
+ *      Tools > Deploy Motion-Aware Curve applies the selected Bezier Curve over the cumulative motion of frame_list
+ *      instead of the frame index, so frames which barely move take less of the eased time
+ *
+ *    Playback Mode
+ *      Play once (stop at NUMBER_FRAMES-1), loop or ping-pong between loop_start and loop_end. Tools > Detect Loop Points
+ *      sets the loop points which wrap most seamlessly (see Loop_Analysis). While looping, the next LOOP_PREFETCH_FRAMES
+ *      frames, across the wrap, are prepared ahead of being shown
+ *
+ *    Variant_Grid
+ *      Tools > Compare Variants opens a window playing several retimings (eg Ease-In, Ease-In/Ease-Out, keyframes) side
+ *      by side, in step with the slider. Every variant draws from frame_list and owns only its content map
+ *
+ *    Smoothness_Scorer
+ *      Tools > Score Deploy History measures how smoothly each deploy plays (jerk, held frames, skips, uneven motion).
+ *      The same scores are written by the --score command line option
+ *
+ *    Playlist_Player
+ *      Tools > Play Playlist opens a window playing several sequences back to back, each with its own curve (see
+ *      Playlist). The next sequence is decoded and retimed in the background while the current one plays
+ *
+ *    Filmstrip
+ *      Tools > Show Filmstrip shows thumbnails of the original timeline over new_timeline, with the original Frame and
+ *      delta of each slot. Only the thumbnails in view are drawn, from a cache
+ *
+ *    Curve_Sweep
+ *      Tools > Sweep Ease-In Curves searches control points on all cores for the curves which best follow an ease-in
+ *      timing profile while staying smooth. The best curves are shown ranked in the Variant_Grid and the best one is
+ *      deployed by Tools > Deploy Best Swept Curve
+ *
+ *    Image_Resampler
+ *      Frames too large for the view are drawn reduced to fit it (Tools > Display Resample Quality). With
+ *      --ingest-width, frames are reduced as they are read in, so that only the reduced frames are held
+ *
+ *    Source_Watcher
+ *      With Tools > Watch Source Directory checked, .png files changed, added or removed in the known directory are
+ *      picked up while running. Only the Frames changed are decoded again and only the slots of frame_new_list showing
+ *      them are deployed again (see reload_source_frames), so there is no need to restart and read in every Frame
+ *
+ *    Indexed Colour Storage
+ *      Tools > Indexed Colour Storage keeps the frames as 8 bit palette indexes (see Palette_Storage), a quarter of the
+ *      memory of 32 bit frames. Frames are expanded to 32 bit colours only when painted
+ *
+ *    Sprite_Atlas
+ *      Tools > Export Sprite Atlas writes frame_new_list as atlas pages holding each distinct frame once, plus a JSON and
+ *      binary table of where each slot's frame is. Also written by the --atlas command line option
+ *
+ *    Playback_Telemetry / Playback_Hud
+ *      Records when each frame is presented while playing, paint time and late/dropped frames. Shown as an overlay
+ *      on the view (Tools > Performance HUD) and exported to CSV/JSON (Tools > Export Frame Telemetry)
+ *
+ *    Memory_Accounting
+ *      Bytes held per subsystem (decoded frames, retimed frames, caches). Current and peak usage is shown in the
+ *      status bar and the report can be dumped from the Tools menu
+ *
  */
-MainWindow::MainWindow(QWidget *parent)
+MainWindow::MainWindow(int ingest_width, Resample_Quality resample_quality, QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
 {
+    this->ingest_width = ingest_width;
+    this->resample_quality = resample_quality;
+    Frame::display_quality = resample_quality;
+
     ui->setupUi(this);
 
     //Setup Slider
@@ -78,12 +198,126 @@ MainWindow::MainWindow(QWidget *parent)
     active_left_frame = nullptr;
     active_right_frame = nullptr;
 
+    //Play once over the whole sequence until loop points are set
+    playback_mode = PLAY_ONCE;
+    loop_start = 0;
+    loop_end = NUMBER_FRAMES-1;
+    play_direction = 1;
+
+    //Jump straight to the frame on skips until Tools > Motion Blur on Skips is checked
+    motion_blur = false;
+    indexed_storage = false;
+
     //Setup Timer to play Frames
     timer = new QTimer();
     connect(timer, SIGNAL(timeout()), this, SLOT(timer_fired()));
 
-    //Read in Frames
+    //Tools menu
+    tools_menu = ui->menubar->addMenu("Tools");
+    tools_menu->addAction("Dump Memory Report...", this, SLOT(dump_memory_report()));
+    QAction *hud_action = tools_menu->addAction("Performance HUD");
+    hud_action->setCheckable(true);
+    connect(hud_action, SIGNAL(toggled(bool)), this, SLOT(toggle_hud(bool)));
+    tools_menu->addAction("Export Frame Telemetry...", this, SLOT(export_telemetry()));
+    tools_menu->addAction("Export Sprite Atlas...", this, SLOT(export_sprite_atlas()));
+    tools_menu->addAction("Clear Retime Cache", this, SLOT(clear_retime_cache()));
+    tools_menu->addSeparator();
+    tools_menu->addAction("Deploy Keyframe Timeline...", this, SLOT(deploy_keyframe_timeline()));
+    tools_menu->addAction("Deploy Example Keyframe Timeline", this, SLOT(deploy_example_keyframe_timeline()));
+    tools_menu->addAction("Deploy Motion-Aware Curve", this, SLOT(deploy_motion_aware_curve()));
+    tools_menu->addAction("Deploy Named Easing...", this, SLOT(deploy_named_easing()));
+    tools_menu->addAction("Extract Curve from Reference...", this, SLOT(extract_reference_curve()));
+    QAction *motion_blur_action = tools_menu->addAction("Motion Blur on Skips");
+    motion_blur_action->setCheckable(true);
+    connect(motion_blur_action, SIGNAL(toggled(bool)), this, SLOT(set_motion_blur(bool)));
+    tools_menu->addSeparator();
+    QMenu *playback_menu = tools_menu->addMenu("Playback Mode");
+    QActionGroup *playback_group = new QActionGroup(this);
+    QStringList playback_names = {"Play Once", "Loop", "Ping-Pong"};
+    for (int i=0; i < playback_names.length(); i++){
+        QAction *action = playback_menu->addAction(playback_names.at(i));
+        action->setCheckable(true);
+        action->setChecked(i == PLAY_ONCE);
+        action->setData(i);
+        playback_group->addAction(action);
+    }
+    connect(playback_group, SIGNAL(triggered(QAction*)), this, SLOT(set_playback_mode(QAction*)));
+    tools_menu->addAction("Detect Loop Points", this, SLOT(detect_loop_points()));
+    QMenu *quality_menu = tools_menu->addMenu("Display Resample Quality");
+    QActionGroup *quality_group = new QActionGroup(this);
+    QStringList quality_names = {"Fast (Box)", "Balanced (Bilinear)", "Best (Lanczos)"};
+    for (int i=0; i < quality_names.length(); i++){
+        QAction *action = quality_menu->addAction(quality_names.at(i));
+        action->setCheckable(true);
+        action->setChecked(i == resample_quality);
+        action->setData(i);
+        quality_group->addAction(action);
+    }
+    connect(quality_group, SIGNAL(triggered(QAction*)), this, SLOT(set_resample_quality(QAction*)));
+    tools_menu->addSeparator();
+    QAction *indexed_action = tools_menu->addAction("Indexed Colour Storage");
+    indexed_action->setCheckable(true);
+    connect(indexed_action, SIGNAL(toggled(bool)), this, SLOT(set_indexed_storage(bool)));
+    tools_menu->addAction("Compare Variants", this, SLOT(show_variant_grid()));
+    tools_menu->addAction("Sweep Ease-In Curves", this, SLOT(sweep_curves()));
+    deploy_swept_action = tools_menu->addAction("Deploy Best Swept Curve", this, SLOT(deploy_swept_curve()));
+    deploy_swept_action->setEnabled(false);
+    tools_menu->addAction("Show Filmstrip", this, SLOT(show_filmstrip()));
+    QAction *watch_action = tools_menu->addAction("Watch Source Directory");
+    watch_action->setCheckable(true);
+    connect(watch_action, SIGNAL(toggled(bool)), this, SLOT(set_source_watching(bool)));
+    tools_menu->addSeparator();
+    undo_action = tools_menu->addAction("Undo Deploy", this, SLOT(undo_deploy()), QKeySequence::Undo);
+    redo_action = tools_menu->addAction("Redo Deploy", this, SLOT(redo_deploy()), QKeySequence::Redo);
+    tools_menu->addAction("Compare Deploy History", this, SLOT(compare_deploy_history()));
+    tools_menu->addAction("Score Deploy History", this, SLOT(score_deploy_history()));
+    tools_menu->addSeparator();
+    tools_menu->addAction("Play Playlist...", this, SLOT(play_playlist()));
+
+    //Performance HUD overlay on the top left of the view. Parented like the Frames so that it can be raised above them
+    hud = new Playback_Hud(&telemetry, this);
+    hud->move(10, ui->menubar->height() + 10);
+
+    //Show memory usage in status bar, refreshed every MEMORY_STATUS_INTERVAL_MSECS
+    memory_label = new QLabel();
+    ui->statusbar->addPermanentWidget(memory_label);
+    memory_timer = new QTimer(this);
+    connect(memory_timer, SIGNAL(timeout()), this, SLOT(update_memory_status()));
+    memory_timer->start(MEMORY_STATUS_INTERVAL_MSECS);
+
+    //Deploy on a worker thread, with progress and cancel in the status bar while running
+    deploy_worker = new Deploy_Worker(this);
+    deploy_progress = new QProgressBar();
+    deploy_progress->setRange(0, 100);
+    deploy_progress->setMaximumWidth(150);
+    deploy_progress->hide();
+    deploy_cancel_button = new QPushButton("Cancel");
+    deploy_cancel_button->hide();
+    ui->statusbar->addWidget(deploy_progress);
+    ui->statusbar->addWidget(deploy_cancel_button);
+    connect(deploy_worker, SIGNAL(progress(int)), deploy_progress, SLOT(setValue(int)));
+    connect(deploy_worker, SIGNAL(deploy_ready(int)), this, SLOT(swap_in_deploy(int)));
+    connect(deploy_cancel_button, SIGNAL(clicked()), this, SLOT(cancel_deploy()));
+
+    //Frames changed on disk are reloaded while Tools > Watch Source Directory is checked
+    source_watcher = new Source_Watcher(this);
+    connect(source_watcher, SIGNAL(frames_changed(QVector<int>)), this, SLOT(reload_source_frames(QVector<int>)));
+
+    //Read in Frames. The original timeline is the first entry of the deploy history
     read_in_frames();
+    timeline_history.push("Original", new_timeline, source_images(), source_images());
+    update_history_actions();
+
+    //Variants are drawn from the original Frames and follow the slider
+    variant_grid = new Variant_Grid(&frame_list);
+    connect(ui->horizontalSlider, SIGNAL(valueChanged(int)), variant_grid, SLOT(set_position(int)));
+    playlist_player = new Playlist_Player();
+
+    //The Filmstrip follows the slider and clicking a slot in it moves the slider
+    filmstrip = new Filmstrip(&frame_list);
+    filmstrip->set_timeline(new_timeline);
+    connect(ui->horizontalSlider, SIGNAL(valueChanged(int)), filmstrip, SLOT(set_position(int)));
+    connect(filmstrip, SIGNAL(position_selected(int)), ui->horizontalSlider, SLOT(setValue(int)));
 
     /*
      * Create a Bezier Curve Window and setup the Bezier Curve (eg Ease-In) and draw
@@ -94,10 +328,22 @@ MainWindow::MainWindow(QWidget *parent)
     //Jigger the slider so that the first frame is displayed in Bezier Curve Window
     ui->horizontalSlider->setValue(NUMBER_FRAMES-1);
     ui->horizontalSlider->setValue(0);
+
+    update_memory_status();
 }
 
 MainWindow::~MainWindow()
 {
+    deploy_worker->cancel();
+    deploy_worker->wait();
+    delete variant_grid;
+    delete playlist_player;
+    delete filmstrip;
+
+    //The Frames' images may use frame_arena, so the Frames go first. The arena then frees all the pixels at once
+    qDeleteAll(frame_new_list);
+    qDeleteAll(frame_list);
+    delete frame_arena;
     delete ui;
 }
 
@@ -118,56 +364,114 @@ void MainWindow::setup_bezier_curve()
  */
 void MainWindow::read_in_frames()
 {
-    QString directory = "C:/Users/Sean/VideoAd/interpolate_data/src/";
-    QPoint left_pos, right_pos;
-    QPoint center = this->rect().center();
+    QString directory = FRAME_DIRECTORY;
 
     /*
      * Create Frames in frame_list from known directory containing filenames in format "1.png", "2.png", ..."<NUMBER_FRAMEs-1>.png"
      * Note that the NUMBER_FRAMES is the presribed number of frames and last filename is <NUMBER_FRAMEs-1>.png
      */
     Frame *frame;
+    QVector<QImage>decoded_images(NUMBER_FRAMES);
     for (int i=0; i< NUMBER_FRAMES; i++){
         frame = new Frame(this);
         frame->image = new QImage();
-        frame->index = i;
-        frame->src_index = i;
         frame_list.append(frame);
-        QString file_str = directory + "3_" + QString::number(i) + "#.png";
+        QString file_str = Frame::frame_filename(directory, i);
         QFile filename(file_str);
         if (filename.exists()){
             frame->filename = file_str;
-            frame->image->load(file_str);
-            frame->setFixedSize(frame->image->width(), frame->image->height());
+            decoded_images[i].load(file_str);
+            //Reduced on ingest, so that only the reduced frames are ever held
+            if (ingest_width > 0)
+                decoded_images[i] = Image_Resampler::reduce_to_width(decoded_images.at(i), ingest_width, resample_quality);
+            frame->telemetry = &telemetry;
         }
    }
 
-   //Create Frames in frame_new_list. The index, image and size are identical to frames_list.
+   /*
+    * Move the decoded pixels into one Frame_Arena for the whole sequence, in the format QPainter draws fastest.
+    * Frames of another size than the first keep their own image.
+    */
+   frame_arena = nullptr;
+   for (int i=0; i < decoded_images.length() && !frame_arena; i++){
+        const QImage &image = decoded_images.at(i);
+        if (!image.isNull())
+            frame_arena = new Frame_Arena(NUMBER_FRAMES, image.size(), image.hasAlphaChannel() ?
+                                              QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+   }
+   for (int i=0; i< NUMBER_FRAMES; i++){
+        frame = frame_list.at(i);
+        if (frame_arena && frame_arena->is_valid())
+            *frame->image = frame_arena->store(i, decoded_images.at(i));
+        else
+            *frame->image = decoded_images.at(i);
+        frame->arena = frame_arena;
+   }
+   decoded_images.clear();
+   for (int i=0; i< NUMBER_FRAMES; i++)
+        frame_list.at(i)->update_memory_accounting();
+
+   //Create Frames in frame_new_list. The image (shared with frame_list) and size are identical to frames_list.
    for (int i=0; i< NUMBER_FRAMES; i++){
         frame = new Frame(this);
-        frame->image = new QImage();
-        frame->index = i;
-        frame->src_index = i;
-        frame->image->load(frame_list.at(i)->filename);
-        frame->setFixedSize(frame->image->width(), frame->image->height());
+        frame->image = new QImage(*frame_list.at(i)->image);
+        frame->arena = frame_arena;
+        frame->memory_subsystem = MEMORY_RETIMED_FRAMES;
+        frame->update_memory_accounting();
+        frame->telemetry = &telemetry;
         frame_new_list.append(frame);
    }
+   new_timeline = identity_timeline(NUMBER_FRAMES);
+
+   layout_frames();
+}
+
+/*
+ * Size the Frames to their images, reduced to fit if they would overflow the view between the menu bar and the slider
+ * (see Frame::display_image), and position them on the left and right side of MainWindow
+ */
+void MainWindow::layout_frames()
+{
+    if (frame_list.isEmpty())
+        return;
+    QPoint left_pos, right_pos;
+    QPoint center = this->rect().center();
+
+    int view_top = ui->menubar->height();
+    int view_bottom = ui->horizontalSlider->mapTo(this, QPoint(0, 0)).y();
+    QSize view_size(this->width() / 2 - 20, 2 * qMin(center.y() - view_top, view_bottom - center.y()) - 20);
+    QSize image_size = frame_list.first()->image->size();
+    QSize frame_size = image_size;
+    if (!image_size.isEmpty() && !view_size.isEmpty() && (image_size.width() > view_size.width()
+                                                          || image_size.height() > view_size.height()))
+        frame_size = image_size.scaled(view_size, Qt::KeepAspectRatio);
+
+    for (int i=0; i < frame_list.length() && i < frame_new_list.length(); i++){
+        frame_list.at(i)->setFixedSize(frame_size);
+        frame_new_list.at(i)->setFixedSize(frame_size);
+    }
 
    /*
     * Setup left Frame and right Frame position in MainWindow display
     */
-   left_pos.setX(center.x() - frame->rect().width() - 10);
-   left_pos.setY(center.y() - frame->rect().height()/2);
+   left_pos.setX(center.x() - frame_size.width() - 10);
+   left_pos.setY(center.y() - frame_size.height()/2);
    right_pos.setX(center.x() + 10);
    right_pos.setY(left_pos.y());
 
    //Update frames positions in the 2 lists accordingly
-   for (int i=0; i< NUMBER_FRAMES; i++){
+   for (int i=0; i < frame_list.length() && i < frame_new_list.length(); i++){
         frame_list.at(i)->move(left_pos);
         frame_new_list.at(i)->move(right_pos);
    }
 }
 
+void MainWindow::resizeEvent(QResizeEvent *event)
+{
+    QMainWindow::resizeEvent(event);
+    layout_frames();
+}
+
 /*
  * Any user initiated change to slider position will call this.
  */
@@ -188,11 +492,18 @@ void MainWindow::on_horizontalSlider_valueChanged(int value)
     active_right_frame->show();
     active_right_frame->repaint();
 
+    //A Frame without a decoded image counts as a miss
+    if (active_left_frame->image->isNull() || active_right_frame->image->isNull())
+        telemetry.record_cache_miss();
+    else
+        telemetry.record_cache_hit();
+    hud->raise();
+
     /*
      * If new index of slider is at end of Slider range (end of frames list and
-     * frames_new_list, stop the timer
+     * frames_new_list, stop the timer. Looping carries on, see next_play_index
      */
-    if (value == NUMBER_FRAMES-1)
+    if (value == NUMBER_FRAMES-1 && playback_mode == PLAY_ONCE)
         timer->stop();
 }
 
@@ -200,6 +511,7 @@ void MainWindow::on_horizontalSlider_valueChanged(int value)
 void MainWindow::on_pushButton_2_pressed()
 {
     timer->stop();
+    telemetry.reset(INTER_FRAME_INTERVAL_MSECS);
     timer->start(INTER_FRAME_INTERVAL_MSECS);
 }
 
@@ -207,6 +519,7 @@ void MainWindow::on_pushButton_2_pressed()
 void MainWindow::on_pushButton_3_pressed()
 {
     timer->stop();
+    telemetry.stop();
 }
 
 /*
@@ -215,13 +528,851 @@ void MainWindow::on_pushButton_3_pressed()
 void MainWindow::timer_fired()
 {
     int current_index = ui->horizontalSlider->value();
-    if (current_index < NUMBER_FRAMES)
-        ui->horizontalSlider->setValue(current_index+1);
+    if (playback_mode == PLAY_ONCE){
+        if (current_index < NUMBER_FRAMES)
+            ui->horizontalSlider->setValue(current_index+1);
+    } else {
+        ui->horizontalSlider->setValue(next_play_index(current_index, &play_direction));
+        prefetch_frames(ui->horizontalSlider->value());
+    }
+    telemetry.record_present(ui->horizontalSlider->value());
+
+    //The last frame of PLAY_ONCE stopped the timer - nothing after it is playback
+    if (!timer->isActive())
+        telemetry.stop();
+}
+
+/*
+ * Index to show after index when looping. *direction is +1 (forward) or -1 (backward) and is reversed at the loop
+ * points in PLAY_PING_PONG
+ */
+int MainWindow::next_play_index(int index, int *direction)
+{
+    if (playback_mode == PLAY_PING_PONG){
+        int next = index + *direction;
+        if (next > loop_end){
+            *direction = -1;
+            next = qMax(loop_start, index-1);
+        } else if (next < loop_start){
+            *direction = 1;
+            next = qMin(loop_end, index+1);
+        }
+        return next;
+    }
+
+    int next = index + 1;
+    if (next > loop_end || next >= NUMBER_FRAMES)
+        next = loop_start;
+    return next;
 }
 
-//Deploy the Bezier Curve and alter the new Frames List(frames_new_list) accordingly
+/*
+ * Prepare the next LOOP_PREFETCH_FRAMES frames to be shown after index - following the loop across the wrap - so that
+ * no frame needs any work at the time it is shown
+ */
+void MainWindow::prefetch_frames(int index)
+{
+    int direction = play_direction;
+    for (int i=0; i < LOOP_PREFETCH_FRAMES; i++){
+        index = next_play_index(index, &direction);
+        prepare_frame_for_display(frame_list.at(index), frame_new_list.at(index));
+        prepare_frame_for_display(frame_new_list.at(index), frame_list.at(index));
+    }
+}
+
+//Display quality of Frames reduced to fit the view, selected from Tools > Display Resample Quality
+void MainWindow::set_resample_quality(QAction *action)
+{
+    Frame::display_quality = (Resample_Quality)action->data().toInt();
+    if (active_left_frame)
+        active_left_frame->update();
+    if (active_right_frame)
+        active_right_frame->update();
+}
+
+/*
+ * Convert frame's image to premultiplied ARGB32, which QPainter draws without any per paint conversion. If
+ * sharing_frame shares the same pixels, it is given the converted image too so the pixels stay shared.
+ */
+void MainWindow::prepare_frame_for_display(Frame *frame, Frame *sharing_frame)
+{
+    if (frame->image->format() == QImage::Format_ARGB32){
+        bool shared = sharing_frame->image->cacheKey() == frame->image->cacheKey();
+        *frame->image = frame->image->convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        frame->update_memory_accounting();
+        if (shared){
+            *sharing_frame->image = *frame->image;
+            sharing_frame->update_memory_accounting();
+        }
+    }
+
+    //Reduced to fit the view ahead of being shown too
+    frame->prepare_display_image();
+}
+
+/*
+ * Deploy the Bezier Curve and alter the new Frames List(frames_new_list) accordingly.
+ * The deploy runs on deploy_worker and is always built from the original Frames (frame_list), so deploying
+ * again does not reapply the curve on an already modified frame_new_list. See swap_in_deploy
+ */
 void MainWindow::on_pushButton_clicked()
 {
-    this->bezier_curve->deploy_bezier_curve(this->frame_new_list);
+    start_bezier_deploy(bezier_curve->selected_bezier_points());
+}
+
+//Deploy points on deploy_worker, drawn in the Bezier Curve Window. A deploy still running is superseded by this one
+void MainWindow::start_bezier_deploy(const Bezier_Points &points)
+{
+    if (deploy_worker->isRunning()){
+        deploy_worker->cancel();
+        deploy_worker->wait();
+    }
+
+    bezier_curve->set_bezier_points(points);
+
+    deploy_progress->setValue(0);
+    deploy_progress->show();
+    deploy_cancel_button->show();
+    deploy_worker->start_deploy(points, bezier_curve->fixed_point, bezier_curve->begin_angle, frame_list, motion_blur);
+}
+
+//Deploy the best curve of the last sweep (see sweep_curves) as the Bezier Curve
+void MainWindow::deploy_swept_curve()
+{
+    if (deploy_swept_action->isEnabled())
+        start_bezier_deploy(best_swept_points);
+}
+
+/*
+ * The back buffer of deploy_worker is complete. Swap it into frame_new_list - this happens on the GUI thread
+ * between two paints, so the right side never shows a partially deployed timeline.
+ */
+void MainWindow::swap_in_deploy(int generation)
+{
+    //Stale - a later deploy has been started since
+    if (generation != deploy_worker->generation)
+        return;
+
+    bezier_curve->degrees_list = deploy_worker->degrees_list;
+    bezier_curve->skip_extend_index_list = deploy_worker->skip_extend_index_list;
+    new_timeline = deploy_worker->timeline;
+    Bezier_Curve::apply_timeline(new_timeline, deploy_worker->back_buffer, frame_new_list);
+    timeline_history.push("Bezier Curve", new_timeline, deploy_worker->back_buffer, source_images());
+    filmstrip->set_timeline(new_timeline);
+    deploy_worker->back_buffer.clear();
+    update_history_actions();
+
+    deploy_progress->hide();
+    deploy_cancel_button->hide();
+    if (active_right_frame)
+        active_right_frame->update();
+    update_memory_status();
+}
+
+/*
+ * Deploy a content map (original Frame to show at each slot of frame_new_list) directly, eg from a Keyframe_Timeline.
+ * Any Bezier Curve deploy still running or not yet swapped in is cancelled so that it does not replace this one. name
+ * is shown in the deploy history.
+ */
+void MainWindow::deploy_content_map(const QVector<int> &content_map, const QString &name)
+{
+    if (deploy_worker->isRunning())
+        cancel_deploy();
+    else
+        deploy_worker->cancel();
+
+    new_timeline = timeline_from_content_map(content_map);
+    QVector<QImage>sources = source_images();
+
+    QVector<QImage>images;
+    for (int i=0; i < new_timeline.length(); i++){
+        if (motion_blur)
+            images.append(Motion_Blur::blurred_slot(new_timeline, i, sources));
+        else
+            images.append(sources.at(new_timeline.content_index.at(i)));
+    }
+
+    Bezier_Curve::apply_timeline(new_timeline, images, frame_new_list);
+    timeline_history.push(name, new_timeline, images, sources);
+    filmstrip->set_timeline(new_timeline);
+    update_history_actions();
+    if (active_right_frame)
+        active_right_frame->update();
+    update_memory_status();
+}
+
+//Images of the original Frames (frame_list). QImage copies share the pixels so this is cheap
+QVector<QImage> MainWindow::source_images()
+{
+    QVector<QImage>images;
+    for (int i=0; i < frame_list.length(); i++)
+        images.append(*frame_list.at(i)->image);
+    return images;
+}
+
+/*
+ * Show snapshot of the deploy history on frame_new_list. A Bezier Curve deploy still running or not yet swapped in is
+ * cancelled, so that it neither replaces the snapshot nor is pushed over the redo history
+ */
+void MainWindow::show_snapshot(const Timeline_Snapshot &snapshot)
+{
+    if (deploy_worker->isRunning())
+        cancel_deploy();
+    else
+        deploy_worker->cancel();
+
+    new_timeline = snapshot.timeline;
+    Bezier_Curve::apply_timeline(new_timeline, Timeline_History::snapshot_images(snapshot, source_images()), frame_new_list);
+    filmstrip->set_timeline(new_timeline);
+    update_history_actions();
+    ui->statusbar->showMessage("Showing deploy: " + snapshot.name, 5000);
+    if (active_right_frame)
+        active_right_frame->update();
+    update_memory_status();
+}
+
+void MainWindow::update_history_actions()
+{
+    undo_action->setEnabled(timeline_history.can_undo());
+    redo_action->setEnabled(timeline_history.can_redo());
+}
+
+void MainWindow::undo_deploy()
+{
+    if (timeline_history.can_undo())
+        show_snapshot(timeline_history.undo());
+}
+
+void MainWindow::redo_deploy()
+{
+    if (timeline_history.can_redo())
+        show_snapshot(timeline_history.redo());
+}
+
+//Play every deploy of the history side by side in the Variant_Grid
+void MainWindow::compare_deploy_history()
+{
+    variant_grid->clear_variants();
+    for (int i=0; i < timeline_history.length(); i++){
+        const Timeline_Snapshot &snapshot = timeline_history.at(i);
+        QString name = QString("%1. %2").arg(i).arg(snapshot.name);
+        if (i == timeline_history.current_index)
+            name += " (current)";
+        variant_grid->add_variant(name, content_map_from_timeline(snapshot.timeline));
+    }
+
+    variant_grid->set_position(ui->horizontalSlider->value());
+    variant_grid->show();
+    variant_grid->raise();
+}
+
+void MainWindow::cancel_deploy()
+{
+    deploy_worker->cancel();
+    deploy_progress->hide();
+    deploy_cancel_button->hide();
+    ui->statusbar->showMessage("Deploy cancelled", 3000);
+}
+
+//Show current and peak memory usage in the status bar
+void MainWindow::update_memory_status()
+{
+    Memory_Accounting *accounting = Memory_Accounting::instance();
+    QString status_str = "Memory: " + Memory_Accounting::format_bytes(accounting->total_current())
+            + " (peak " + Memory_Accounting::format_bytes(accounting->total_peak()) + ")";
+    memory_label->setText(status_str);
+
+    QString tooltip_str;
+    for (int i=0; i < MEMORY_SUBSYSTEM_COUNT; i++){
+        Memory_Subsystem subsystem = (Memory_Subsystem) i;
+        tooltip_str.append(Memory_Accounting::subsystem_name(subsystem) + ": "
+                           + Memory_Accounting::format_bytes(accounting->current(subsystem)) + " (peak "
+                           + Memory_Accounting::format_bytes(accounting->peak(subsystem)) + ")\n");
+    }
+    memory_label->setToolTip(tooltip_str.trimmed());
+}
+
+//Dump the memory report to a file selected by the user
+void MainWindow::dump_memory_report()
+{
+    qDebug().noquote() << Memory_Accounting::instance()->report();
+
+    QString filename = QFileDialog::getSaveFileName(this, "Dump Memory Report", "memory_report.txt", "Text files (*.txt)");
+    if (filename.isEmpty())
+        return;
+
+    if (!Memory_Accounting::instance()->dump_report(filename))
+        ui->statusbar->showMessage("Unable to write " + filename, 5000);
+}
+
+
+void MainWindow::toggle_hud(bool checked)
+{
+    if (checked){
+        hud->show();
+        hud->raise();
+    } else
+        hud->hide();
+}
+
+//Export the frame telemetry of the last play as CSV or JSON, selected by the file suffix
+void MainWindow::export_telemetry()
+{
+    QString filename = QFileDialog::getSaveFileName(this, "Export Frame Telemetry", "telemetry.csv",
+                                                    "CSV files (*.csv);;JSON files (*.json)");
+    if (filename.isEmpty())
+        return;
+
+    bool ok;
+    if (filename.endsWith(".json", Qt::CaseInsensitive))
+        ok = telemetry.export_json(filename);
+    else
+        ok = telemetry.export_csv(filename);
+
+    if (!ok)
+        ui->statusbar->showMessage("Unable to write " + filename, 5000);
+}
+
+//Remove all cached retiming results, in memory and on disk
+void MainWindow::clear_retime_cache()
+{
+    Retime_Cache::instance()->clear();
+    update_memory_status();
+}
+
+//Deploy a Keyframe_Timeline loaded from a JSON file
+void MainWindow::deploy_keyframe_timeline()
+{
+    QString filename = QFileDialog::getOpenFileName(this, "Deploy Keyframe Timeline", "", "JSON files (*.json)");
+    if (filename.isEmpty())
+        return;
+
+    Keyframe_Timeline keyframe_timeline;
+    if (!keyframe_timeline.load(filename)){
+        ui->statusbar->showMessage("Unable to read keyframes from " + filename, 5000);
+        return;
+    }
+    deploy_content_map(keyframe_timeline.retime(frame_new_list.length(), frame_list.length()),
+                       "Keyframes " + QFileInfo(filename).fileName());
+}
+
+//Deploy the example ease-in, hold, ease-out Keyframe_Timeline
+void MainWindow::deploy_example_keyframe_timeline()
+{
+    Keyframe_Timeline keyframe_timeline = Keyframe_Timeline::ease_hold_ease(frame_list.length());
+    deploy_content_map(keyframe_timeline.retime(frame_new_list.length(), frame_list.length()), "Ease-Hold-Ease Keyframes");
+}
+
+//Playback mode selected from Tools > Playback Mode
+void MainWindow::set_playback_mode(QAction *action)
+{
+    playback_mode = (Playback_Mode) action->data().toInt();
+    play_direction = 1;
+    if (playback_mode != PLAY_ONCE)
+        prefetch_frames(ui->horizontalSlider->value());
+}
+
+//Find the most seamless loop points of the original Frames and loop between them
+void MainWindow::detect_loop_points()
+{
+    QVector<QImage>images;
+    for (int i=0; i < frame_list.length(); i++)
+        images.append(*frame_list.at(i)->image);
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QVector<Loop_Points>loop_points = Loop_Analysis::find_loop_points(images);
+    QApplication::restoreOverrideCursor();
+
+    if (loop_points.isEmpty()){
+        ui->statusbar->showMessage("No loop points found", 5000);
+        return;
+    }
+
+    for (int i=0; i < loop_points.length(); i++)
+        qDebug() << "Loop points" << loop_points.at(i).loop_start << "-" << loop_points.at(i).loop_end
+                 << "score=" << loop_points.at(i).score;
+
+    loop_start = loop_points.first().loop_start;
+    loop_end = loop_points.first().loop_end;
+    ui->statusbar->showMessage(QString("Loop %1 - %2 (difference %3)").arg(loop_start).arg(loop_end)
+                               .arg(loop_points.first().score, 0, 'f', 2), 5000);
+}
+
+/*
+ * Convert the original Frames to indexed colour storage (indexed is true) or back to 32 bit colour.
+ * The converted Frames are moved into a Frame_Arena of the new format and the previous arena is freed, so indexed
+ * Frames take a quarter of the memory rather than being held alongside the 32 bit ones.
+ * Frames of frame_new_list sharing an original Frame's pixels are given the converted image too, so they stay shared.
+ */
+void MainWindow::set_indexed_storage(bool indexed)
+{
+    indexed_storage = indexed;
+
+    //The worker reads the original Frames' pixels, which are about to be freed. Deployed again from the converted ones
+    bool redeploy = deploy_worker->isRunning();
+    deploy_worker->cancel();
+    deploy_worker->wait();
+    deploy_worker->back_buffer.clear();
+    if (redeploy){
+        deploy_progress->hide();
+        deploy_cancel_button->hide();
+    }
+
+    QVector<QImage>images;
+    for (int i=0; i < frame_list.length(); i++)
+        images.append(*frame_list.at(i)->image);
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    int converted = 0;
+    if (indexed)
+        converted = Palette_Storage::convert_to_indexed(images);
+    else {
+        for (int i=0; i < images.length(); i++){
+            if (images.at(i).format() == QImage::Format_Indexed8)
+                converted++;
+        }
+        Palette_Storage::convert_to_colour(images);
+    }
+
+    Frame_Arena *previous_arena = frame_arena;
+    if (converted > 0)
+        move_into_arena(images, indexed ? QImage::Format_Indexed8 : QImage::Format_ARGB32_Premultiplied);
+
+    QHash<qint64, QImage>converted_images;
+    for (int i=0; i < frame_list.length(); i++){
+        converted_images.insert(frame_list.at(i)->image->cacheKey(), images.at(i));
+        *frame_list.at(i)->image = images.at(i);
+        frame_list.at(i)->arena = frame_arena;
+    }
+    for (int i=0; i < frame_new_list.length(); i++){
+        Frame *frame = frame_new_list.at(i);
+        if (converted_images.contains(frame->image->cacheKey()))
+            *frame->image = converted_images.value(frame->image->cacheKey());
+        else if (previous_arena != frame_arena && previous_arena && previous_arena->contains(frame->image->constBits()))
+            *frame->image = frame->image->copy();
+        frame->arena = frame_arena;
+    }
+
+    //Account only once the Frames are the last holders of the images
+    images.clear();
+    converted_images.clear();
+    for (int i=0; i < frame_list.length(); i++)
+        frame_list.at(i)->update_memory_accounting();
+    for (int i=0; i < frame_new_list.length(); i++)
+        frame_new_list.at(i)->update_memory_accounting();
+
+    //No image uses the previous arena any more
+    if (previous_arena != frame_arena)
+        delete previous_arena;
+    QApplication::restoreOverrideCursor();
+
+    filmstrip->clear_thumbnails();
+
+    if (indexed)
+        ui->statusbar->showMessage(QString("%1 of %2 frames indexed").arg(converted).arg(frame_list.length()), 5000);
+    if (active_left_frame)
+        active_left_frame->update();
+    if (active_right_frame)
+        active_right_frame->update();
+    update_memory_status();
+
+    if (redeploy)
+        start_bezier_deploy(deploy_worker->points);
+}
+
+/*
+ * Store images into a new frame_arena of format, sized to the first image of that format, replacing frame_arena.
+ * Images which cannot be stored (another size, or not indexed for an indexed arena) are copied out of the previous
+ * arena, so that it can be freed once the Frames no longer use it. The caller frees the previous arena
+ */
+void MainWindow::move_into_arena(QVector<QImage> &images, QImage::Format format)
+{
+    Frame_Arena *previous_arena = frame_arena;
+    frame_arena = nullptr;
+    for (int i=0; i < images.length() && !frame_arena; i++){
+        if (!images.at(i).isNull() && (format != QImage::Format_Indexed8 || images.at(i).format() == format))
+            frame_arena = new Frame_Arena(images.length(), images.at(i).size(), format);
+    }
+    if (frame_arena && !frame_arena->is_valid()){
+        delete frame_arena;
+        frame_arena = nullptr;
+    }
+
+    for (int i=0; i < images.length(); i++){
+        const QImage &image = images.at(i);
+        if (frame_arena && image.size() == frame_arena->size
+                && (format != QImage::Format_Indexed8 || image.format() == format))
+            images[i] = frame_arena->store(i, image);
+        else if (previous_arena && previous_arena->contains(image.constBits()))
+            images[i] = image.copy();
+    }
+}
+
+/*
+ * Show the Variant_Grid with a variant for each curve preset. Only the content maps are calculated - the retimings
+ * themselves come from Retime_Cache when the same curve has been deployed before
+ */
+void MainWindow::show_variant_grid()
+{
+    int frame_count = frame_list.length();
+    bool fixed_point = bezier_curve->fixed_point;
+    qreal begin_angle = bezier_curve->begin_angle;
+
+    //S-shaped Ease-In Ease-Out Bezier Curve, see Bezier_Curve::selected_bezier_points
+    Bezier_Points ease_in_ease_out = {QPoint(37,110), QPoint(117,4), QPoint(1775,162), QPoint(1884,37)};
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    variant_grid->clear_variants();
+    variant_grid->add_variant("Original", content_map_from_timeline(identity_timeline(frame_count)));
+    variant_grid->add_variant("Ease-In", Bezier_Curve::compute_content_map(bezier_curve->selected_bezier_points(),
+                                                                          fixed_point, begin_angle, frame_count));
+    variant_grid->add_variant("Ease-In Ease-Out", Bezier_Curve::compute_content_map(ease_in_ease_out, fixed_point,
+                                                                                   begin_angle, frame_count));
+    variant_grid->add_variant("Ease-In-Out Cubic", retime_with_easing(Power_Ease_In_Out<3>(), frame_count, frame_count));
+    variant_grid->add_variant("Ease-Hold-Ease Keyframes",
+                              Keyframe_Timeline::ease_hold_ease(frame_count).retime(frame_count, frame_count));
+    variant_grid->add_variant("Ease-In Motion-Aware", motion_aware_content_map(bezier_curve->selected_bezier_points()));
+    QApplication::restoreOverrideCursor();
+
+    variant_grid->set_position(ui->horizontalSlider->value());
+    variant_grid->show();
+    variant_grid->raise();
+}
+
+/*
+ * Sweep the control points of the Bezier Curve for the curves closest to an ease-in (Easing_Table(0.42, 0, 1, 1)).
+ * The best curve is drawn in the Bezier Curve Window, and deployed by Tools > Deploy Best Swept Curve. The ranked curves
+ * are compared in the Variant_Grid
+ */
+void MainWindow::sweep_curves()
+{
+    Curve_Sweep curve_sweep(bezier_curve->points.p0, bezier_curve->points.p1, frame_list.length());
+    curve_sweep.set_target_profile(Easing_Table(0.42, 0.0, 1.0, 1.0));
+
+    QElapsedTimer sweep_timer;
+    sweep_timer.start();
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QVector<Sweep_Candidate>ranked = curve_sweep.sweep();
+    QApplication::restoreOverrideCursor();
+    qint64 elapsed_msecs = qMax(Q_INT64_C(1), sweep_timer.elapsed());
+
+    if (ranked.isEmpty()){
+        ui->statusbar->showMessage("No curves found", 5000);
+        return;
+    }
+
+    variant_grid->clear_variants();
+    variant_grid->add_variant("Original", content_map_from_timeline(identity_timeline(frame_list.length())));
+    for (int i=0; i < ranked.length(); i++){
+        const Bezier_Points &points = ranked.at(i).points;
+        qDebug() << "Sweep" << i+1 << "score=" << ranked.at(i).score << "p0=" << points.p0 << "c1=" << points.c1
+                 << "c2=" << points.c2 << "p1=" << points.p1;
+        variant_grid->add_variant(QString("#%1 (%2)").arg(i+1).arg(ranked.at(i).score, 0, 'f', 2), ranked.at(i).content_map);
+    }
+    variant_grid->set_position(ui->horizontalSlider->value());
+    variant_grid->show();
+    variant_grid->raise();
+
+    bezier_curve->set_bezier_points(ranked.first().points);
+    best_swept_points = ranked.first().points;
+    deploy_swept_action->setEnabled(true);
+    ui->statusbar->showMessage(QString("%1 curves in %2 ms (%3 curves/s)").arg(curve_sweep.evaluated_count)
+                               .arg(elapsed_msecs).arg(curve_sweep.evaluated_count * 1000 / elapsed_msecs), 5000);
 }
 
+/*
+ * Content map easing the motion of frame_list (rather than its frame index) along the Bezier Curve points. The motion
+ * energy is measured once, on first use
+ */
+QVector<int> MainWindow::motion_aware_content_map(const Bezier_Points &points)
+{
+    return Motion_Analysis::retime(Motion_Analysis::cumulative_motion(source_motion_energy()), Easing_Table::from_bezier_points(points),
+                                   frame_new_list.length());
+}
+
+//Deploy the selected Bezier Curve over the motion of the original Frames
+void MainWindow::deploy_motion_aware_curve()
+{
+    Bezier_Points points = bezier_curve->selected_bezier_points();
+    bezier_curve->set_bezier_points(points);
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QVector<int>content_map = motion_aware_content_map(points);
+    QApplication::restoreOverrideCursor();
+
+    deploy_content_map(content_map, "Motion-Aware Curve");
+}
+
+/*
+ * Deploy an easing chosen by name (see Easing_Function::from_name), eg "ease-in-out-cubic" or
+ * "cubic-bezier(0.42, 0, 0.58, 1)"
+ */
+void MainWindow::deploy_named_easing()
+{
+    bool ok;
+    QString name = QInputDialog::getItem(this, "Deploy Named Easing", "Easing:", Easing_Function::names(), 0, true, &ok);
+    if (!ok || name.isEmpty())
+        return;
+
+    Easing_Function easing = Easing_Function::from_name(name, &ok);
+    if (!ok){
+        ui->statusbar->showMessage("Unknown easing " + name, 5000);
+        return;
+    }
+    deploy_content_map(retime_with_easing(easing, frame_new_list.length(), frame_list.length()), name);
+}
+
+//Motion blur applies from the next deploy on
+void MainWindow::set_motion_blur(bool enabled)
+{
+    motion_blur = enabled;
+    ui->statusbar->showMessage(enabled ? "Motion blur on skips - deploy again to apply" : "Motion blur off - deploy again to apply", 5000);
+}
+
+//Play a Playlist loaded from a JSON file in the Playlist_Player
+void MainWindow::play_playlist()
+{
+    QString filename = QFileDialog::getOpenFileName(this, "Play Playlist", "", "JSON files (*.json)");
+    if (filename.isEmpty())
+        return;
+
+    if (!playlist_player->load_playlist(filename)){
+        ui->statusbar->showMessage("Unable to read a playlist from " + filename, 5000);
+        return;
+    }
+    playlist_player->show();
+    playlist_player->raise();
+    playlist_player->play();
+}
+
+void MainWindow::show_filmstrip()
+{
+    filmstrip->show();
+    filmstrip->raise();
+    filmstrip->set_position(ui->horizontalSlider->value());
+}
+
+//Motion energy of the original Frames (see Motion_Analysis), calculated on first use
+const QVector<qreal> &MainWindow::source_motion_energy()
+{
+    if (motion_energy.length() != frame_list.length())
+        motion_energy = Motion_Analysis::motion_energy(source_images());
+    return motion_energy;
+}
+
+//Score every deploy of the history on all cores and list the scores, lowest (smoothest) marked
+void MainWindow::score_deploy_history()
+{
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QVector<QVector<int>>content_maps;
+    for (int i=0; i < timeline_history.length(); i++)
+        content_maps.append(content_map_from_timeline(timeline_history.at(i).timeline));
+    QVector<Smoothness_Report>reports = Smoothness_Scorer::score_all(content_maps, source_motion_energy());
+    QApplication::restoreOverrideCursor();
+
+    int best = 0;
+    for (int i=1; i < reports.length(); i++){
+        if (reports.at(i).score < reports.at(best).score)
+            best = i;
+    }
+
+    QString text;
+    for (int i=0; i < reports.length(); i++){
+        const Smoothness_Report &report = reports.at(i);
+        text += QString("%1%2. %3: score %4 - rms jerk %5, held %6 slots, largest skip %7 (slot %8), motion discontinuity %9\n")
+                    .arg(i == best ? "* " : "").arg(i).arg(timeline_history.at(i).name)
+                    .arg(report.score, 0, 'f', 3).arg(report.rms_jerk, 0, 'f', 3).arg(report.longest_duplicate_run)
+                    .arg(report.largest_skip).arg(report.largest_skip_slot).arg(report.rms_motion_discontinuity, 0, 'f', 3);
+    }
+    QMessageBox::information(this, "Deploy Smoothness (lower is smoother)", text);
+}
+
+/*
+ * Extract the timing of a reference animation - an eased version of frame_list, in a directory of .png files named as
+ * the Frames - and deploy the fitted cubic-bezier, or the fitted Keyframe_Timeline if the cubic-bezier cannot follow
+ * it. The matching and both fits are compared in the Variant_Grid.
+ */
+void MainWindow::extract_reference_curve()
+{
+    QString directory = QFileDialog::getExistingDirectory(this, "Reference Animation");
+    if (directory.isEmpty())
+        return;
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QVector<QImage>reference = Curve_Extraction::read_sequence(directory);
+    Extracted_Curve curve = Curve_Extraction::extract(source_images(), reference);
+    QApplication::restoreOverrideCursor();
+    if (curve.content_map.isEmpty()){
+        ui->statusbar->showMessage("No reference frames read from " + directory, 5000);
+        return;
+    }
+
+    int frame_count = frame_new_list.length();
+    int src_frame_count = frame_list.length();
+    QVector<int>easing_map = retime_with_easing(curve.easing, frame_count, src_frame_count);
+    QVector<int>keyframes_map = Curve_Extraction::rescale(curve.keyframes, reference.length(), frame_count)
+                                    .retime(frame_count, src_frame_count);
+
+    variant_grid->clear_variants();
+    variant_grid->add_variant("Reference (matched)", curve.content_map);
+    variant_grid->add_variant(curve.easing_name(), easing_map);
+    variant_grid->add_variant(QString("%1 Keyframes").arg(curve.keyframes.frames.length()), keyframes_map);
+    variant_grid->set_position(ui->horizontalSlider->value());
+    variant_grid->show();
+
+    if (curve.easing_error <= EXTRACTION_KEYFRAME_TOLERANCE)
+        deploy_content_map(easing_map, "Extracted " + curve.easing_name());
+    else
+        deploy_content_map(keyframes_map, "Extracted Keyframes");
+    ui->statusbar->showMessage(QString("Extracted %1 (off by %2 frames), keyframes off by %3 frames, match difference %4")
+                                   .arg(curve.easing_name()).arg(curve.easing_error, 0, 'f', 2)
+                                   .arg(curve.keyframes_error, 0, 'f', 2).arg(curve.match_error, 0, 'f', 2), 10000);
+}
+
+//Export the retimed Frames (frame_new_list) as a Sprite_Atlas
+void MainWindow::export_sprite_atlas()
+{
+    QString filename = QFileDialog::getSaveFileName(this, "Export Sprite Atlas", "atlas.json", "JSON files (*.json)");
+    if (filename.isEmpty())
+        return;
+    QFileInfo file_info(filename);
+    QString base = file_info.dir().filePath(file_info.completeBaseName());
+
+    QVector<QImage>slot_images;
+    for (int i=0; i < frame_new_list.length(); i++)
+        slot_images.append(*frame_new_list.at(i)->image);
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    Sprite_Atlas atlas;
+    atlas.build(slot_images);
+    bool saved = atlas.save(base, 1000 / INTER_FRAME_INTERVAL_MSECS);
+    QApplication::restoreOverrideCursor();
+
+    if (saved)
+        ui->statusbar->showMessage(QString("Exported %1 slots as %2 frames on %3 pages").arg(atlas.slot_frames.length())
+                                       .arg(atlas.frames.length()).arg(atlas.page_sizes.length()), 5000);
+    else
+        ui->statusbar->showMessage("Unable to write the sprite atlas " + base, 5000);
+}
+
+/*
+ * Watch the known directory for changed Frames (see Source_Watcher) or stop. The files as they are when watching starts
+ * are taken to be the Frames read in
+ */
+void MainWindow::set_source_watching(bool watching)
+{
+    if (!watching){
+        source_watcher->stop();
+        return;
+    }
+    if (!source_watcher->start(FRAME_DIRECTORY, frame_list.length()))
+        ui->statusbar->showMessage(QString("Unable to watch ") + FRAME_DIRECTORY, 5000);
+}
+
+//One original Frame to decode again, see reload_source_frames
+struct Source_Reload_Job
+{
+    int index;
+    QString filename;
+    QImage image;
+};
+
+/*
+ * Decode again the original Frames at indexes, changed on disk since they were read in, and deploy the current
+ * timeline again on only the slots of frame_new_list which show them or blend them (see Motion_Blur). Every other Frame
+ * keeps its image. A deploy still running was built from the old Frames, so it is started again.
+ */
+void MainWindow::reload_source_frames(const QVector<int> &indexes)
+{
+    //The worker reads the original Frames' pixels, which are about to be overwritten in frame_arena
+    bool redeploy = deploy_worker->isRunning();
+    if (redeploy){
+        deploy_worker->cancel();
+        deploy_worker->wait();
+    }
+
+    //Decoded on all cores, reduced on ingest as when read in. A removed file leaves a null image, as a missing one does
+    QVector<Source_Reload_Job>jobs;
+    for (int i=0; i < indexes.length(); i++){
+        if (indexes.at(i) >= 0 && indexes.at(i) < frame_list.length())
+            jobs.append({indexes.at(i), Frame::frame_filename(source_watcher->directory, indexes.at(i)), QImage()});
+    }
+    int width = ingest_width;
+    Resample_Quality quality = resample_quality;
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QtConcurrent::blockingMap(jobs, [width, quality](Source_Reload_Job &job) {
+        if (job.image.load(job.filename) && width > 0)
+            job.image = Image_Resampler::reduce_to_width(job.image, width, quality);
+    });
+
+    //Kept in the storage the other Frames are in - indexed, and back in their slot of frame_arena if it holds that format
+    QVector<QImage>decoded_images;
+    for (int i=0; i < jobs.length(); i++)
+        decoded_images.append(jobs.at(i).image);
+    if (indexed_storage)
+        Palette_Storage::convert_to_indexed(decoded_images);
+
+    QSet<int>changed;
+    for (int i=0; i < jobs.length(); i++){
+        Frame *frame = frame_list.at(jobs.at(i).index);
+        const QImage &decoded = decoded_images.at(i);
+        if (frame_arena && frame_arena->is_valid()
+                && (frame_arena->format != QImage::Format_Indexed8 || decoded.format() == QImage::Format_Indexed8))
+            *frame->image = frame_arena->store(jobs.at(i).index, decoded);
+        else
+            *frame->image = decoded;
+        frame->filename = decoded.isNull() ? QString() : jobs.at(i).filename;
+        frame->telemetry = &telemetry;
+        frame->update_memory_accounting();
+        changed.insert(jobs.at(i).index);
+    }
+    decoded_images.clear();
+
+    /*
+     * Deploy the current timeline again on the slots affected. A slot with an image of its own in the deploy history
+     * is blended (see Motion_Blur::blurred_slot) and is blended again if any Frame it blends changed
+     */
+    QVector<QImage>sources = source_images();
+    const Timeline_Snapshot &snapshot = timeline_history.current();
+    QVector<QImage>images = Timeline_History::snapshot_images(snapshot, sources);
+    int redeployed = 0;
+    for (int i=0; i < new_timeline.length() && i < frame_new_list.length(); i++){
+        int content_index = new_timeline.content_index.at(i);
+        if (snapshot.images.value(i).isNull()){
+            if (!changed.contains(content_index))
+                continue;
+            images[i] = sources.at(content_index);
+        } else {
+            int previous = (i == 0) ? 0 : new_timeline.content_index.at(i-1);
+            bool blends_changed = false;
+            for (int j=previous+1; j <= content_index && !blends_changed; j++)
+                blends_changed = changed.contains(j);
+            if (!blends_changed)
+                continue;
+            images[i] = Motion_Blur::blurred_slot(new_timeline, i, sources);
+        }
+        *frame_new_list.at(i)->image = images.at(i);
+        frame_new_list.at(i)->update_memory_accounting();
+        redeployed++;
+    }
+    timeline_history.update_current(images, sources);
+    images.clear();
+    QApplication::restoreOverrideCursor();
+
+    //The motion of the original Frames is measured again on next use
+    motion_energy.clear();
+    filmstrip->remove_thumbnails(changed.values().toVector());
+    variant_grid->update();
+    layout_frames();
+
+    ui->statusbar->showMessage(QString("Reloaded %1 frames, %2 slots deployed again").arg(changed.size()).arg(redeployed),
+                               5000);
+    if (active_left_frame)
+        active_left_frame->update();
+    if (active_right_frame)
+        active_right_frame->update();
+    update_memory_status();
+
+    if (redeploy)
+        start_bezier_deploy(deploy_worker->points);
+}
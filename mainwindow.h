@@ -3,8 +3,34 @@
 
 #include <QMainWindow>
 #include <QTimer>
+#include <QLabel>
+#include <QMenu>
+#include <QProgressBar>
+#include <QPushButton>
 #include "frame.h"
 #include "bezier_curve.h"
+#include "playback_telemetry.h"
+#include "playback_hud.h"
+#include "deploy_worker.h"
+#include "keyframe_timeline.h"
+#include "variant_grid.h"
+#include "timeline_history.h"
+#include "playlist_player.h"
+#include "filmstrip.h"
+#include "image_resampler.h"
+#include "source_watcher.h"
+
+/*
+ * Playback_Mode
+ *   PLAY_ONCE      - play to the last frame and stop
+ *   PLAY_LOOP      - wrap from loop_end back to loop_start endlessly
+ *   PLAY_PING_PONG - play forward to loop_end, then backward to loop_start, endlessly
+ */
+enum Playback_Mode {
+    PLAY_ONCE = 0,
+    PLAY_LOOP,
+    PLAY_PING_PONG
+};
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -15,21 +41,93 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
 public:
-    MainWindow(QWidget *parent = nullptr);
+    MainWindow(int ingest_width = 0, Resample_Quality resample_quality = RESAMPLE_BALANCED, QWidget *parent = nullptr);
     ~MainWindow();
 
     Bezier_Curve *bezier_curve;
     QTimer *timer;
+    QTimer *memory_timer;
+    QLabel *memory_label;
+    QMenu *tools_menu;
+    Playback_Telemetry telemetry;
+    Playback_Hud *hud;
+    Deploy_Worker *deploy_worker;
+    Variant_Grid *variant_grid;
+    Playlist_Player *playlist_player;
+    Filmstrip *filmstrip;
+    Source_Watcher *source_watcher;
+    QProgressBar *deploy_progress;
+    QPushButton *deploy_cancel_button;
     Frame *active_left_frame;
     Frame *active_right_frame;
     QList<Frame *>frame_list;
     QList<Frame *>frame_new_list;
+    Frame_Arena *frame_arena;
+    Retime_Timeline new_timeline;
+    Timeline_History timeline_history;
+    QAction *undo_action;
+    QAction *redo_action;
+    QAction *deploy_swept_action;
+    Bezier_Points best_swept_points;
+    Playback_Mode playback_mode;
+    int loop_start;
+    int loop_end;
+    int play_direction;
+    QVector<qreal>motion_energy;
+    bool motion_blur;
+    bool indexed_storage;
+    int ingest_width;
+    Resample_Quality resample_quality;
 
     void setup_bezier_curve();
     void read_in_frames();
+    void layout_frames();
+    void move_into_arena(QVector<QImage> &images, QImage::Format format);
+    void start_bezier_deploy(const Bezier_Points &points);
+    void deploy_content_map(const QVector<int> &content_map, const QString &name);
+    void show_snapshot(const Timeline_Snapshot &snapshot);
+    void update_history_actions();
+    QVector<QImage> source_images();
+    int next_play_index(int index, int *direction);
+    void prefetch_frames(int index);
+    void prepare_frame_for_display(Frame *frame, Frame *sharing_frame);
+    QVector<int> motion_aware_content_map(const Bezier_Points &points);
+    const QVector<qreal> &source_motion_energy();
 
 public slots:
     void timer_fired();
+    void update_memory_status();
+    void dump_memory_report();
+    void toggle_hud(bool checked);
+    void export_telemetry();
+    void clear_retime_cache();
+    void swap_in_deploy(int generation);
+    void cancel_deploy();
+    void deploy_keyframe_timeline();
+    void deploy_example_keyframe_timeline();
+    void deploy_motion_aware_curve();
+    void deploy_named_easing();
+    void set_playback_mode(QAction *action);
+    void set_resample_quality(QAction *action);
+    void detect_loop_points();
+    void set_indexed_storage(bool indexed);
+    void set_motion_blur(bool enabled);
+    void show_variant_grid();
+    void sweep_curves();
+    void deploy_swept_curve();
+    void undo_deploy();
+    void redo_deploy();
+    void compare_deploy_history();
+    void play_playlist();
+    void show_filmstrip();
+    void score_deploy_history();
+    void extract_reference_curve();
+    void export_sprite_atlas();
+    void set_source_watching(bool watching);
+    void reload_source_frames(const QVector<int> &indexes);
+
+protected:
+    void resizeEvent(QResizeEvent *event);
 
 private slots:
     void on_horizontalSlider_valueChanged(int value);
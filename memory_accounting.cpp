@@ -0,0 +1,122 @@
+#include <QFile>
+#include <QTextStream>
+#include <QDateTime>
+#include <QLocale>
+#include <QMutexLocker>
+#include "memory_accounting.h"
+
+Memory_Accounting::Memory_Accounting()
+{
+    for (int i=0; i < MEMORY_SUBSYSTEM_COUNT; i++){
+        current_bytes[i] = 0;
+        peak_bytes[i] = 0;
+    }
+    total_current_bytes = 0;
+    total_peak_bytes = 0;
+}
+
+Memory_Accounting *Memory_Accounting::instance()
+{
+    static Memory_Accounting memory_accounting;
+    return &memory_accounting;
+}
+
+//Account for bytes newly held by subsystem
+void Memory_Accounting::add(Memory_Subsystem subsystem, qint64 bytes)
+{
+    QMutexLocker locker(&mutex);
+    current_bytes[subsystem] += bytes;
+    total_current_bytes += bytes;
+    if (current_bytes[subsystem] > peak_bytes[subsystem])
+        peak_bytes[subsystem] = current_bytes[subsystem];
+    if (total_current_bytes > total_peak_bytes)
+        total_peak_bytes = total_current_bytes;
+}
+
+//Account for bytes no longer held by subsystem
+void Memory_Accounting::release(Memory_Subsystem subsystem, qint64 bytes)
+{
+    QMutexLocker locker(&mutex);
+    current_bytes[subsystem] -= bytes;
+    total_current_bytes -= bytes;
+}
+
+qint64 Memory_Accounting::current(Memory_Subsystem subsystem)
+{
+    QMutexLocker locker(&mutex);
+    return current_bytes[subsystem];
+}
+
+qint64 Memory_Accounting::peak(Memory_Subsystem subsystem)
+{
+    QMutexLocker locker(&mutex);
+    return peak_bytes[subsystem];
+}
+
+qint64 Memory_Accounting::total_current()
+{
+    QMutexLocker locker(&mutex);
+    return total_current_bytes;
+}
+
+qint64 Memory_Accounting::total_peak()
+{
+    QMutexLocker locker(&mutex);
+    return total_peak_bytes;
+}
+
+QString Memory_Accounting::subsystem_name(Memory_Subsystem subsystem)
+{
+    switch (subsystem){
+        case MEMORY_DECODED_FRAMES:
+            return "Decoded Frames";
+        case MEMORY_RETIMED_FRAMES:
+            return "Retimed Frames";
+        case MEMORY_CACHES:
+            return "Caches";
+        default:
+            break;
+    }
+    return "Unknown";
+}
+
+QString Memory_Accounting::format_bytes(qint64 bytes)
+{
+    return QLocale::system().formattedDataSize(bytes);
+}
+
+/*
+ * Report of current and peak usage per subsystem, eg
+ *   Decoded Frames   current=39.7 MB  peak=39.7 MB
+ */
+QString Memory_Accounting::report()
+{
+    QString report_str;
+    QTextStream stream(&report_str);
+
+    stream << "Memory Report " << QDateTime::currentDateTime().toString(Qt::ISODate) << "\n";
+    for (int i=0; i < MEMORY_SUBSYSTEM_COUNT; i++){
+        Memory_Subsystem subsystem = (Memory_Subsystem) i;
+        stream << subsystem_name(subsystem).leftJustified(16)
+               << " current=" << format_bytes(current(subsystem)) << " (" << current(subsystem) << " bytes)"
+               << "  peak=" << format_bytes(peak(subsystem)) << " (" << peak(subsystem) << " bytes)\n";
+    }
+    stream << QString("Total").leftJustified(16)
+           << " current=" << format_bytes(total_current()) << " (" << total_current() << " bytes)"
+           << "  peak=" << format_bytes(total_peak()) << " (" << total_peak() << " bytes)\n";
+    stream.flush();
+
+    return report_str;
+}
+
+//Write report() to filename. Returns false if the file cannot be written
+bool Memory_Accounting::dump_report(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+
+    QTextStream stream(&file);
+    stream << report();
+    return true;
+}
@@ -0,0 +1,52 @@
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QString>
+
+/*
+ * Subsystems which memory is accounted for
+ *   MEMORY_DECODED_FRAMES - images of frame_list as read in from the known directory
+ *   MEMORY_RETIMED_FRAMES - images of frame_new_list, including copies made when the Bezier Curve is deployed
+ *   MEMORY_CACHES         - any cache kept to speed up processing
+ */
+enum Memory_Subsystem {
+    MEMORY_DECODED_FRAMES = 0,
+    MEMORY_RETIMED_FRAMES,
+    MEMORY_CACHES,
+    MEMORY_SUBSYSTEM_COUNT
+};
+
+/*
+ * Memory_Accounting tracks the current and peak number of bytes held by each subsystem.
+ * There is a single instance (see instance()) which may be updated from any thread.
+ */
+class Memory_Accounting
+{
+public:
+    static Memory_Accounting *instance();
+
+    void add(Memory_Subsystem subsystem, qint64 bytes);
+    void release(Memory_Subsystem subsystem, qint64 bytes);
+    qint64 current(Memory_Subsystem subsystem);
+    qint64 peak(Memory_Subsystem subsystem);
+    qint64 total_current();
+    qint64 total_peak();
+
+    QString report();
+    bool dump_report(const QString &filename);
+
+    static QString subsystem_name(Memory_Subsystem subsystem);
+    static QString format_bytes(qint64 bytes);
+
+private:
+    Memory_Accounting();
+    QMutex mutex;
+    qint64 current_bytes[MEMORY_SUBSYSTEM_COUNT];
+    qint64 peak_bytes[MEMORY_SUBSYSTEM_COUNT];
+    qint64 total_current_bytes;
+    qint64 total_peak_bytes;
+};
+
+#endif // MEMORY_ACCOUNTING_H
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <QtConcurrent>
+#include "motion_analysis.h"
+#include "simd_kernels.h"
+#include "tile_grid.h"
+
+//The frame whose motion energy is measured and its score
+struct Motion_Step
+{
+    int frame;
+    qreal energy;
+};
+
+/*
+ * Motion energy of each frame - mean absolute difference per channel (0 to 255) from the previous frame. The first
+ * frame has none. Frames which cannot be compared (different size) count as no motion.
+ */
+QVector<qreal> Motion_Analysis::motion_energy(const QVector<QImage> &frames)
+{
+    QVector<Motion_Step>steps;
+    for (int i=1; i < frames.length(); i++)
+        steps.append({i, 0.0});
+
+    //Large frames are compared one at a time, each across all cores tile by tile
+    if (!frames.isEmpty() && Tile_Grid::use_tiles(frames.first().size())){
+        for (int i=0; i < steps.length(); i++)
+            steps[i].energy = qMax(0.0, Tile_Grid::image_difference(frames.at(steps.at(i).frame-1), frames.at(steps.at(i).frame)));
+    } else {
+        QtConcurrent::blockingMap(steps, [&frames](Motion_Step &step) {
+            step.energy = qMax(0.0, image_difference(frames.at(step.frame-1), frames.at(step.frame)));
+        });
+    }
+
+    QVector<qreal>energy(frames.length(), 0.0);
+    for (int i=0; i < steps.length(); i++)
+        energy[steps.at(i).frame] = steps.at(i).energy;
+    return energy;
+}
+
+/*
+ * Cumulative motion at each frame normalized from 0 (first frame) to 1 (last frame). Every step counts as at least
+ * MOTION_MIN_ENERGY_PERCENT of the mean motion. Without any motion at all, every step counts the same.
+ */
+QVector<qreal> Motion_Analysis::cumulative_motion(const QVector<qreal> &energy)
+{
+    QVector<qreal>cumulative(energy.length(), 0.0);
+    if (energy.length() < 2)
+        return cumulative;
+
+    qreal total = 0.0;
+    for (int i=1; i < energy.length(); i++)
+        total += energy.at(i);
+    qreal min_energy = total / (energy.length()-1) * MOTION_MIN_ENERGY_PERCENT / 100;
+    if (total <= 0.0)
+        min_energy = 1.0;
+
+    for (int i=1; i < energy.length(); i++)
+        cumulative[i] = cumulative.at(i-1) + qMax(energy.at(i), min_energy);
+
+    qreal last = cumulative.last();
+    for (int i=1; i < cumulative.length(); i++)
+        cumulative[i] = cumulative.at(i) / last;
+    return cumulative;
+}
+
+/*
+ * Content map of frame_count indexes - the source frame shown at each index is the one whose cumulative motion is
+ * closest to the eased progress at that index
+ */
+QVector<int> Motion_Analysis::retime(const QVector<qreal> &cumulative, const Easing_Table &easing, int frame_count)
+{
+    QVector<int>content_map;
+    if (cumulative.isEmpty())
+        return content_map;
+
+    for (int i=0; i < frame_count; i++){
+        qreal progress = frame_count > 1 ? easing.ease((qreal)i / (frame_count-1)) : 0.0;
+        int src_frame = std::lower_bound(cumulative.begin(), cumulative.end(), progress) - cumulative.begin();
+        if (src_frame >= cumulative.length())
+            src_frame = cumulative.length()-1;
+        else if (src_frame > 0 && (progress - cumulative.at(src_frame-1)) < (cumulative.at(src_frame) - progress))
+            src_frame--;
+        content_map.append(src_frame);
+    }
+    return content_map;
+}
@@ -0,0 +1,29 @@
+#ifndef MOTION_ANALYSIS_H
+#define MOTION_ANALYSIS_H
+
+#include <QtGlobal>
+#include <QImage>
+#include <QVector>
+#include "easing_table.h"
+
+/*
+ * MOTION_MIN_ENERGY_PERCENT - every step between 2 frames counts as at least this percentage of the mean motion, so that
+ *                             still frames are passed through quickly rather than skipped altogether
+ */
+#define MOTION_MIN_ENERGY_PERCENT 5
+
+/*
+ * Motion_Analysis retimes over perceived motion rather than frame index. Animations rarely move by the same amount every
+ * frame, so easing the frame index eases the motion unevenly. The motion energy of each frame is the mean absolute
+ * difference from the previous frame (the vectorized image_difference kernel, frames in parallel). The easing curve is
+ * then applied to the cumulative motion - ie at x% of the time, the frame reached after y% of the total motion is shown.
+ */
+class Motion_Analysis
+{
+public:
+    static QVector<qreal> motion_energy(const QVector<QImage> &frames);
+    static QVector<qreal> cumulative_motion(const QVector<qreal> &energy);
+    static QVector<int> retime(const QVector<qreal> &cumulative, const Easing_Table &easing, int frame_count);
+};
+
+#endif // MOTION_ANALYSIS_H
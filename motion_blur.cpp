@@ -0,0 +1,49 @@
+#include "motion_blur.h"
+#include "tile_grid.h"
+
+/*
+ * Average of images, equally weighted (the weight left over from MOTION_BLUR_WEIGHT_TOTAL goes to the last images).
+ * Blended premultiplied tile by tile (see Tile_Grid::blend), so that transparent pixels do not darken the result.
+ * A null image if the images differ in size.
+ */
+QImage Motion_Blur::blend(const QVector<QImage> &images)
+{
+    if (images.isEmpty())
+        return QImage();
+    if (images.length() == 1)
+        return images.first();
+
+    int count = images.length();
+    QVector<quint16>weights;
+    for (int i=0; i < count; i++)
+        weights.append(MOTION_BLUR_WEIGHT_TOTAL / count + ((count - 1 - i) < (MOTION_BLUR_WEIGHT_TOTAL % count) ? 1 : 0));
+
+    return Tile_Grid::blend(images, weights);
+}
+
+//Whether slot shows a source frame more than one frame on from the previous slot's (from frame 0 for the first slot)
+bool Motion_Blur::skips(const Retime_Timeline &timeline, int slot)
+{
+    int previous = (slot == 0) ? 0 : timeline.content_index.at(slot-1);
+    return timeline.content_index.at(slot) - previous > 1;
+}
+
+/*
+ * Image of slot blurred over the source frames skipped since the previous slot, up to and including the slot's own
+ * source frame. The source frame as is when nothing is skipped.
+ */
+QImage Motion_Blur::blurred_slot(const Retime_Timeline &timeline, int slot, const QVector<QImage> &source_images)
+{
+    int content_index = timeline.content_index.at(slot);
+    if (!skips(timeline, slot))
+        return source_images.at(content_index);
+
+    int previous = (slot == 0) ? 0 : timeline.content_index.at(slot-1);
+    int first = qMax(previous + 1, content_index - MOTION_BLUR_MAX_FRAMES + 1);
+    QVector<QImage>skipped;
+    for (int i=first; i <= content_index; i++)
+        skipped.append(source_images.at(i));
+
+    QImage blurred = blend(skipped);
+    return blurred.isNull() ? source_images.at(content_index) : blurred;
+}
@@ -0,0 +1,30 @@
+#ifndef MOTION_BLUR_H
+#define MOTION_BLUR_H
+
+#include <QtGlobal>
+#include <QImage>
+#include <QVector>
+#include "retime_timeline.h"
+
+/*
+ * MOTION_BLUR_WEIGHT_TOTAL - the weights of the frames blended into one sum to this (see accumulate_weighted)
+ * MOTION_BLUR_MAX_FRAMES   - at most this many of the frames skipped, the latest, are blended into one
+ */
+#define MOTION_BLUR_WEIGHT_TOTAL 256
+#define MOTION_BLUR_MAX_FRAMES 32
+
+/*
+ * Motion_Blur blends the source frames a retimed frame skips over into that frame, as a camera shutter open for the
+ * whole interval would. eg a slot showing source frame 19 right after source frame 0 shows the average of source
+ * frames 1 to 19 instead of jumping to 19, which avoids the strobing look of large skips. Frames are accumulated
+ * with the vectorized accumulate_weighted kernel, tile by tile, so the cost is proportional to the skip.
+ */
+class Motion_Blur
+{
+public:
+    static QImage blend(const QVector<QImage> &images);
+    static QImage blurred_slot(const Retime_Timeline &timeline, int slot, const QVector<QImage> &source_images);
+    static bool skips(const Retime_Timeline &timeline, int slot);
+};
+
+#endif // MOTION_BLUR_H
@@ -0,0 +1,129 @@
+#include <QHash>
+#include "palette_storage.h"
+#include "simd_kernels.h"
+
+/*
+ * Add the colours of image to *palette (which may already hold colours, eg from other frames).
+ * Returns false as soon as there are more than 256 colours.
+ */
+bool Palette_Storage::build_palette(const QImage &image, QVector<QRgb> *palette)
+{
+    QImage colour_image = image.convertToFormat(QImage::Format_ARGB32);
+    if (colour_image.isNull())
+        return true;
+
+    QHash<QRgb, int>colours;
+    for (int i=0; i < palette->length(); i++)
+        colours.insert(palette->at(i), i);
+
+    for (int y=0; y < colour_image.height(); y++){
+        const QRgb *line = (const QRgb *)colour_image.constScanLine(y);
+        QRgb previous = line[0] + 1;
+        for (int x=0; x < colour_image.width(); x++){
+            //Neighbouring pixels are mostly the same colour
+            if (line[x] == previous)
+                continue;
+            previous = line[x];
+
+            if (!colours.contains(line[x])){
+                if (palette->length() == 256)
+                    return false;
+                colours.insert(line[x], palette->length());
+                palette->append(line[x]);
+            }
+        }
+    }
+    return true;
+}
+
+//Indexed copy of image. palette must hold every colour of image (see build_palette)
+QImage Palette_Storage::to_indexed(const QImage &image, const QVector<QRgb> &palette)
+{
+    QImage colour_image = image.convertToFormat(QImage::Format_ARGB32);
+    QImage indexed(colour_image.size(), QImage::Format_Indexed8);
+    indexed.setColorTable(palette);
+
+    QHash<QRgb, int>colours;
+    for (int i=0; i < palette.length(); i++)
+        colours.insert(palette.at(i), i);
+
+    for (int y=0; y < colour_image.height(); y++){
+        const QRgb *line = (const QRgb *)colour_image.constScanLine(y);
+        uchar *indexed_line = indexed.scanLine(y);
+        QRgb previous = line[0];
+        int previous_index = colours.value(previous);
+        for (int x=0; x < colour_image.width(); x++){
+            if (line[x] != previous){
+                previous = line[x];
+                previous_index = colours.value(previous);
+            }
+            indexed_line[x] = (uchar)previous_index;
+        }
+    }
+    return indexed;
+}
+
+/*
+ * Convert images to indexed colour, in place. A shared palette is tried first, then a palette per image.
+ * Returns the number of images now indexed.
+ */
+int Palette_Storage::convert_to_indexed(QVector<QImage> &images)
+{
+    QVector<QRgb>shared_palette;
+    bool use_shared_palette = true;
+    for (int i=0; i < images.length() && use_shared_palette; i++){
+        if (!images.at(i).isNull() && images.at(i).format() != QImage::Format_Indexed8)
+            use_shared_palette = build_palette(images.at(i), &shared_palette);
+    }
+
+    int converted = 0;
+    for (int i=0; i < images.length(); i++){
+        QImage &image = images[i];
+        if (image.isNull())
+            continue;
+        if (image.format() == QImage::Format_Indexed8){
+            converted++;
+            continue;
+        }
+
+        if (use_shared_palette){
+            image = to_indexed(image, shared_palette);
+            converted++;
+            continue;
+        }
+
+        QVector<QRgb>palette;
+        if (build_palette(image, &palette)){
+            image = to_indexed(image, palette);
+            converted++;
+        }
+    }
+    return converted;
+}
+
+//Convert indexed images back to 32 bit colour, in place
+void Palette_Storage::convert_to_colour(QVector<QImage> &images)
+{
+    for (int i=0; i < images.length(); i++){
+        if (images.at(i).format() == QImage::Format_Indexed8)
+            images[i] = images.at(i).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+}
+
+/*
+ * Expand indexed into *display as premultiplied 32 bit colours, which QPainter draws directly.
+ * *display is reused between calls and only reallocated when the size changes.
+ */
+void Palette_Storage::expand_for_display(const QImage &indexed, QImage *display)
+{
+    if (display->size() != indexed.size() || display->format() != QImage::Format_ARGB32_Premultiplied)
+        *display = QImage(indexed.size(), QImage::Format_ARGB32_Premultiplied);
+
+    QRgb palette[256];
+    QVector<QRgb>color_table = indexed.colorTable();
+    for (int i=0; i < 256; i++)
+        palette[i] = i < color_table.length() ? qPremultiply(color_table.at(i)) : 0;
+
+    for (int y=0; y < indexed.height(); y++)
+        expand_palette(indexed.constScanLine(y), palette, (QRgb *)display->scanLine(y), indexed.width());
+}
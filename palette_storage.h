@@ -0,0 +1,24 @@
+#ifndef PALETTE_STORAGE_H
+#define PALETTE_STORAGE_H
+
+#include <QImage>
+#include <QVector>
+
+/*
+ * Palette_Storage keeps frames with 256 colours or less (eg extracted from a GIF) as 8 bit palette indexes
+ * (QImage::Format_Indexed8) rather than 32 bit colours - a quarter of the memory. The palette is shared by all frames
+ * when their colours fit in one palette, otherwise each frame has its own. Frames with more colours stay 32 bit.
+ *
+ * Indexed frames are expanded back to 32 bit colours only when drawn (see expand_for_display).
+ */
+class Palette_Storage
+{
+public:
+    static bool build_palette(const QImage &image, QVector<QRgb> *palette);
+    static QImage to_indexed(const QImage &image, const QVector<QRgb> &palette);
+    static int convert_to_indexed(QVector<QImage> &images);
+    static void convert_to_colour(QVector<QImage> &images);
+    static void expand_for_display(const QImage &indexed, QImage *display);
+};
+
+#endif // PALETTE_STORAGE_H
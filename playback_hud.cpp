@@ -0,0 +1,46 @@
+#include <QPainter>
+#include "playback_hud.h"
+
+Playback_Hud::Playback_Hud(Playback_Telemetry *telemetry, QWidget *parent)
+    : QWidget{parent}
+{
+    this->telemetry = telemetry;
+
+    //Overlay only - let the mouse through to the widgets underneath
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setFixedSize(220, 100);
+
+    //Refresh only while shown
+    refresh_timer = new QTimer(this);
+    connect(refresh_timer, SIGNAL(timeout()), this, SLOT(update()));
+    hide();
+}
+
+void Playback_Hud::showEvent(QShowEvent *event)
+{
+    refresh_timer->start(HUD_REFRESH_INTERVAL_MSECS);
+    QWidget::showEvent(event);
+}
+
+void Playback_Hud::hideEvent(QHideEvent *event)
+{
+    refresh_timer->stop();
+    QWidget::hideEvent(event);
+}
+
+//Draw the telemetry figures on a translucent background
+void Playback_Hud::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    painter.fillRect(this->rect(), QColor(0, 0, 0, 160));
+    painter.setPen(Qt::green);
+
+    QStringList lines;
+    lines << QString("FPS: %1").arg(telemetry->achieved_fps(), 0, 'f', 1);
+    lines << QString("Paint: %1 ms").arg(telemetry->average_paint_msecs(), 0, 'f', 2);
+    lines << QString("Cache hit: %1 %").arg(telemetry->cache_hit_rate() * 100, 0, 'f', 1);
+    lines << QString("Late: %1  Dropped: %2").arg(telemetry->late_frames).arg(telemetry->dropped_frames);
+    lines << QString("Presented: %1").arg(telemetry->presented_frames());
+
+    painter.drawText(this->rect().adjusted(8, 4, -8, -4), Qt::AlignLeft | Qt::AlignTop, lines.join("\n"));
+}
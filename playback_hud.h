@@ -0,0 +1,28 @@
+#ifndef PLAYBACK_HUD_H
+#define PLAYBACK_HUD_H
+
+#include <QWidget>
+#include <QTimer>
+#include "playback_telemetry.h"
+
+#define HUD_REFRESH_INTERVAL_MSECS 250
+
+/*
+ * Playback_Hud is an overlay drawn on top of the MainWindow view showing the playback performance as recorded
+ * by Playback_Telemetry - achieved FPS, paint time, cache hit rate and late/dropped frames
+ */
+class Playback_Hud : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit Playback_Hud(Playback_Telemetry *telemetry, QWidget *parent = nullptr);
+    Playback_Telemetry *telemetry;
+    QTimer *refresh_timer;
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void showEvent(QShowEvent *event);
+    void hideEvent(QHideEvent *event);
+};
+
+#endif // PLAYBACK_HUD_H
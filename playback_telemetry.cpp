@@ -0,0 +1,247 @@
+#include <QFile>
+#include <QTextStream>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include "playback_telemetry.h"
+
+/*
+ * Store value as sample number count of ring, which keeps the last capacity samples - sample n is at n % capacity.
+ * The ring grows up to capacity, so a short playback does not allocate all of it
+ */
+template <typename T>
+static void ring_store(QVector<T> *ring, int count, const T &value, int capacity)
+{
+    if (ring->length() < capacity)
+        ring->append(value);
+    else
+        (*ring)[count % capacity] = value;
+}
+
+Playback_Telemetry::Playback_Telemetry()
+{
+    reset(0);
+    recording = false;
+}
+
+/*
+ * Clear all records and start recording. expected_interval_msecs is the timer interval the frames are supposed to be
+ * presented at
+ */
+void Playback_Telemetry::reset(int expected_interval_msecs)
+{
+    expected_interval_nsecs = (qint64) expected_interval_msecs * 1000000;
+    present_count = 0;
+    present_nsecs.clear();
+    present_interval_nsecs.clear();
+    present_frame_index.clear();
+    paint_count = 0;
+    paint_nsecs.clear();
+    histogram.clear();
+    late_frames = 0;
+    dropped_frames = 0;
+    cache_hits = 0;
+    cache_misses = 0;
+    recording = true;
+    clock.start();
+}
+
+//Stop recording, eg when playback stops. The records are kept until the next reset
+void Playback_Telemetry::stop()
+{
+    recording = false;
+}
+
+/*
+ * Record the time frame_index is presented. The interval from the previous present is checked against the
+ * expected interval
+ *   late    - interval is more than TELEMETRY_LATE_PERCENT longer than expected
+ *   dropped - number of whole expected intervals missed, ie timer ticks that never presented a frame
+ */
+void Playback_Telemetry::record_present(int frame_index)
+{
+    if (!recording)
+        return;
+
+    qint64 nsecs = clock.nsecsElapsed();
+    qint64 interval = 0;
+    if (present_count > 0)
+        interval = nsecs - present_nsecs.at((present_count-1) % TELEMETRY_MAX_SAMPLES);
+
+    ring_store(&present_nsecs, present_count, nsecs, TELEMETRY_MAX_SAMPLES);
+    ring_store(&present_interval_nsecs, present_count, interval, TELEMETRY_MAX_SAMPLES);
+    ring_store(&present_frame_index, present_count, frame_index, TELEMETRY_MAX_SAMPLES);
+    present_count++;
+
+    if (present_count < 2)
+        return;
+
+    int bin = (int)(interval / ((qint64)TELEMETRY_HISTOGRAM_BIN_MS * 1000000));
+    if (bin >= histogram.length())
+        histogram.resize(bin+1);
+    histogram[bin]++;
+
+    if (is_late(interval)){
+        late_frames++;
+        dropped_frames += (int)((interval + expected_interval_nsecs/2) / expected_interval_nsecs) - 1;
+    }
+}
+
+void Playback_Telemetry::record_paint(qint64 nsecs)
+{
+    if (!recording)
+        return;
+
+    ring_store(&paint_nsecs, paint_count, nsecs, TELEMETRY_FPS_WINDOW);
+    paint_count++;
+}
+
+void Playback_Telemetry::record_cache_hit()
+{
+    if (recording)
+        cache_hits++;
+}
+
+void Playback_Telemetry::record_cache_miss()
+{
+    if (recording)
+        cache_misses++;
+}
+
+int Playback_Telemetry::presented_frames()
+{
+    return present_count;
+}
+
+//Number of the oldest present still stored, see TELEMETRY_MAX_SAMPLES
+int Playback_Telemetry::first_stored_present()
+{
+    return qMax(0, present_count - TELEMETRY_MAX_SAMPLES);
+}
+
+bool Playback_Telemetry::is_late(qint64 interval)
+{
+    return expected_interval_nsecs > 0 && interval * 100 > expected_interval_nsecs * (100 + TELEMETRY_LATE_PERCENT);
+}
+
+//FPS over the last TELEMETRY_FPS_WINDOW presents
+qreal Playback_Telemetry::achieved_fps()
+{
+    if (present_count < 2)
+        return 0.0;
+
+    int first = qMax(0, present_count - TELEMETRY_FPS_WINDOW);
+    qint64 elapsed = present_nsecs.at((present_count-1) % TELEMETRY_MAX_SAMPLES)
+                     - present_nsecs.at(first % TELEMETRY_MAX_SAMPLES);
+    if (elapsed <= 0)
+        return 0.0;
+    return (qreal)(present_count - 1 - first) * 1e9 / elapsed;
+}
+
+//Average paint time over the last TELEMETRY_FPS_WINDOW paints
+qreal Playback_Telemetry::average_paint_msecs()
+{
+    if (paint_nsecs.isEmpty())
+        return 0.0;
+
+    qint64 total = 0;
+    for (int i=0; i < paint_nsecs.length(); i++)
+        total += paint_nsecs.at(i);
+    return (qreal)total / paint_nsecs.length() / 1e6;
+}
+
+qreal Playback_Telemetry::cache_hit_rate()
+{
+    int total = cache_hits + cache_misses;
+    if (total == 0)
+        return 1.0;
+    return (qreal)cache_hits / total;
+}
+
+/*
+ * Number of intervals in each TELEMETRY_HISTOGRAM_BIN_MS bin. Bin N counts intervals from N*bin to (N+1)*bin msecs.
+ * Counts every present since the reset, including those no longer stored
+ */
+QVector<int> Playback_Telemetry::interval_histogram()
+{
+    return histogram;
+}
+
+/*
+ * Export to CSV. First section is one row per presented frame still stored (the last TELEMETRY_MAX_SAMPLES), second
+ * section is the interval histogram
+ *   present,frame_index,timestamp_ms,interval_ms,late
+ *   ...
+ *   bin_start_ms,bin_end_ms,count
+ *   ...
+ */
+bool Playback_Telemetry::export_csv(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+
+    QTextStream stream(&file);
+    stream << "present,frame_index,timestamp_ms,interval_ms,late\n";
+    for (int i=first_stored_present(); i < present_count; i++){
+        int sample = i % TELEMETRY_MAX_SAMPLES;
+        qint64 interval = present_interval_nsecs.at(sample);
+        stream << i << "," << present_frame_index.at(sample) << ","
+               << QString::number(present_nsecs.at(sample) / 1e6, 'f', 3) << ","
+               << QString::number(interval / 1e6, 'f', 3) << ","
+               << (i > 0 && is_late(interval) ? 1 : 0) << "\n";
+    }
+
+    stream << "\nbin_start_ms,bin_end_ms,count\n";
+    QVector<int>histogram = interval_histogram();
+    for (int i=0; i < histogram.length(); i++)
+        stream << i*TELEMETRY_HISTOGRAM_BIN_MS << "," << (i+1)*TELEMETRY_HISTOGRAM_BIN_MS << "," << histogram.at(i) << "\n";
+
+    return true;
+}
+
+//Export the same records as export_csv plus a summary, as a JSON document
+bool Playback_Telemetry::export_json(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QJsonArray frames_array;
+    for (int i=first_stored_present(); i < present_count; i++){
+        int sample = i % TELEMETRY_MAX_SAMPLES;
+        qint64 interval = present_interval_nsecs.at(sample);
+        QJsonObject frame_object;
+        frame_object["frame_index"] = present_frame_index.at(sample);
+        frame_object["timestamp_ms"] = present_nsecs.at(sample) / 1e6;
+        frame_object["interval_ms"] = interval / 1e6;
+        frame_object["late"] = i > 0 && is_late(interval);
+        frames_array.append(frame_object);
+    }
+
+    QJsonArray histogram_array;
+    QVector<int>histogram = interval_histogram();
+    for (int i=0; i < histogram.length(); i++)
+        histogram_array.append(histogram.at(i));
+
+    QJsonObject histogram_object;
+    histogram_object["bin_ms"] = TELEMETRY_HISTOGRAM_BIN_MS;
+    histogram_object["counts"] = histogram_array;
+
+    QJsonObject summary_object;
+    summary_object["expected_interval_ms"] = expected_interval_nsecs / 1e6;
+    summary_object["presented_frames"] = presented_frames();
+    summary_object["achieved_fps"] = achieved_fps();
+    summary_object["average_paint_ms"] = average_paint_msecs();
+    summary_object["late_frames"] = late_frames;
+    summary_object["dropped_frames"] = dropped_frames;
+    summary_object["cache_hit_rate"] = cache_hit_rate();
+
+    QJsonObject root_object;
+    root_object["summary"] = summary_object;
+    root_object["frames"] = frames_array;
+    root_object["interval_histogram"] = histogram_object;
+
+    file.write(QJsonDocument(root_object).toJson());
+    return true;
+}
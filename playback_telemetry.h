@@ -0,0 +1,70 @@
+#ifndef PLAYBACK_TELEMETRY_H
+#define PLAYBACK_TELEMETRY_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <QString>
+#include <QElapsedTimer>
+
+/*
+ * TELEMETRY_FPS_WINDOW       - number of most recent frame presents used to calculate the achieved FPS and paint time
+ * TELEMETRY_LATE_PERCENT     - a frame is late if its interval exceeds the expected interval by this percentage
+ * TELEMETRY_HISTOGRAM_BIN_MS - width in msecs of each bin in the interval histogram
+ * TELEMETRY_MAX_SAMPLES      - number of most recent frame presents kept for export (5 minutes at 60 FPS). Older
+ *                              presents still count in the totals and the histogram
+ */
+#define TELEMETRY_FPS_WINDOW 30
+#define TELEMETRY_LATE_PERCENT 50
+#define TELEMETRY_HISTOGRAM_BIN_MS 1
+#define TELEMETRY_MAX_SAMPLES 18000
+
+/*
+ * Playback_Telemetry records when each frame is presented during playback, how long the Frames take to paint and
+ * whether the frame image was available (cache hit) or not. From these, it derives the achieved FPS, late and dropped
+ * frames and a histogram of the frame intervals, which can be exported to CSV or JSON for offline analysis.
+ *
+ * Only playback is recorded - from reset() when play starts to stop() - so paints while scrubbing or resizing are
+ * not. The samples are kept in ring buffers, so a looping playback does not grow them.
+ */
+class Playback_Telemetry
+{
+public:
+    Playback_Telemetry();
+
+    void reset(int expected_interval_msecs);
+    void stop();
+    void record_present(int frame_index);
+    void record_paint(qint64 paint_nsecs);
+    void record_cache_hit();
+    void record_cache_miss();
+
+    qreal achieved_fps();
+    qreal average_paint_msecs();
+    qreal cache_hit_rate();
+    int late_frames;
+    int dropped_frames;
+    int presented_frames();
+    QVector<int> interval_histogram();
+
+    bool export_csv(const QString &filename);
+    bool export_json(const QString &filename);
+
+private:
+    QElapsedTimer clock;
+    bool recording;
+    qint64 expected_interval_nsecs;
+    int present_count;
+    QVector<qint64>present_nsecs;
+    QVector<qint64>present_interval_nsecs;
+    QVector<int>present_frame_index;
+    int paint_count;
+    QVector<qint64>paint_nsecs;
+    QVector<int>histogram;
+    int cache_hits;
+    int cache_misses;
+
+    int first_stored_present();
+    bool is_late(qint64 interval);
+};
+
+#endif // PLAYBACK_TELEMETRY_H
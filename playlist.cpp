@@ -0,0 +1,36 @@
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include "playlist.h"
+#include "bezier_curve.h"
+
+bool Playlist::load(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll());
+    if (!document.isObject())
+        return false;
+
+    items.clear();
+    QJsonArray items_array = document.object().value("items").toArray();
+    for (int i=0; i < items_array.size(); i++){
+        QJsonObject item_object = items_array.at(i).toObject();
+        Playlist_Item item;
+        item.directory = item_object.value("directory").toString();
+        item.easing = item_object.value("easing").toString();
+        item.points = Bezier_Curve::selected_bezier_points();
+        QJsonArray points_array = item_object.value("points").toArray();
+        if (points_array.size() == 8)
+            item.points = {QPoint(points_array.at(0).toInt(), points_array.at(1).toInt()),
+                           QPoint(points_array.at(2).toInt(), points_array.at(3).toInt()),
+                           QPoint(points_array.at(4).toInt(), points_array.at(5).toInt()),
+                           QPoint(points_array.at(6).toInt(), points_array.at(7).toInt())};
+        if (!item.directory.isEmpty())
+            items.append(item);
+    }
+    return !items.isEmpty();
+}
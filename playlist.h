@@ -0,0 +1,37 @@
+#ifndef PLAYLIST_H
+#define PLAYLIST_H
+
+#include <QString>
+#include <QVector>
+#include "bezier_points.h"
+
+/*
+ * Playlist_Item is one sequence of a Playlist and the curve it is retimed with
+ *   directory - .png files of the sequence, named as Frame::frame_filename, from index 0 up to the first missing file
+ *   easing    - easing name (see Easing_Function::from_name). If empty, points is used
+ *   points    - Bezier Curve of the sequence, the selected Bezier Curve unless given
+ */
+struct Playlist_Item
+{
+    QString directory;
+    QString easing;
+    Bezier_Points points;
+};
+
+/*
+ * Playlist is a list of sequences played back to back (see Playlist_Player). Loaded from a JSON file, eg
+ *   {"items": [{"directory": "C:/clock/", "easing": "ease-in-out-cubic"},
+ *              {"directory": "C:/ball/", "points": [37, 110, 127, 20, 1884, 37, 1884, 37]},
+ *              {"directory": "C:/clock/"}]}
+ */
+class Playlist
+{
+public:
+    QVector<Playlist_Item>items;
+
+    bool load(const QString &filename);
+    int length() const { return items.length(); }
+    bool isEmpty() const { return items.isEmpty(); }
+};
+
+#endif // PLAYLIST_H
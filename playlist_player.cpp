@@ -0,0 +1,173 @@
+#include <QPainter>
+#include <QCloseEvent>
+#include <QDebug>
+#include "playlist_player.h"
+#include "frame.h"
+
+Playlist_Player::Playlist_Player(QWidget *parent)
+    : QWidget{parent}
+{
+    active_item = -1;
+    next_item = -1;
+    position = 0;
+    stalls = 0;
+    setWindowTitle("Playlist");
+    resize(640, 480);
+
+    loader = new Sequence_Loader(this);
+    connect(loader, SIGNAL(sequence_ready(int)), this, SLOT(sequence_ready(int)));
+    timer = new QTimer(this);
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer, SIGNAL(timeout()), this, SLOT(advance()));
+}
+
+Playlist_Player::~Playlist_Player()
+{
+    loader->cancel();
+    loader->wait();
+}
+
+//Replace the playlist with the one in filename and play it from the first item
+bool Playlist_Player::load_playlist(const QString &filename)
+{
+    Playlist loaded;
+    if (!loaded.load(filename))
+        return false;
+
+    //A load of the previous playlist must not start playing once finished
+    stop();
+    loader->cancel();
+    loader->wait();
+    playlist = loaded;
+    active = Loaded_Sequence();
+    next = Loaded_Sequence();
+    active_item = -1;
+    next_item = -1;
+    position = 0;
+    stalls = 0;
+    return true;
+}
+
+//Play from the current position. The first item is loaded first if nothing has been played yet
+void Playlist_Player::play()
+{
+    if (playlist.isEmpty())
+        return;
+    if (active.isEmpty()){
+        if (!loader->isRunning())
+            preload(0);
+        return;
+    }
+    timer->start(INTER_FRAME_INTERVAL_MSECS);
+}
+
+void Playlist_Player::stop()
+{
+    timer->stop();
+}
+
+//Load item_index on the loader, superseding any load still running
+void Playlist_Player::preload(int item_index)
+{
+    if (loader->isRunning()){
+        loader->cancel();
+        loader->wait();
+    }
+    next = Loaded_Sequence();
+    loader->start_load(playlist.items.at(item_index), item_index);
+}
+
+/*
+ * The loader has finished. The first sequence starts playing straight away, any other waits in next for the active
+ * sequence to end.
+ */
+void Playlist_Player::sequence_ready(int generation)
+{
+    //Stale - a later load has been started since
+    if (generation != loader->generation)
+        return;
+
+    if (!loader->error.isEmpty()){
+        qWarning().noquote() << "Playlist item" << loader->item_index << "skipped:" << loader->error;
+        /*
+         * Try the item after, unless that comes round to the active item or (before anything plays) back to the start.
+         * When no other item loads, the active sequence plays again after itself rather than stalling
+         */
+        int following = (loader->item_index + 1) % playlist.length();
+        if (following == active_item){
+            next = active;
+            next_item = active_item;
+        } else if (!(active.isEmpty() && following == 0))
+            preload(following);
+        return;
+    }
+
+    if (active.isEmpty()){
+        start_sequence(loader->sequence, loader->item_index);
+        timer->start(INTER_FRAME_INTERVAL_MSECS);
+    } else {
+        next = loader->sequence;
+        next_item = loader->item_index;
+    }
+    loader->sequence = Loaded_Sequence();
+}
+
+//Make sequence the active one and start loading the item after it
+void Playlist_Player::start_sequence(const Loaded_Sequence &sequence, int item_index)
+{
+    active = sequence;
+    active_item = item_index;
+    position = 0;
+    setWindowTitle(QString("Playlist - %1 of %2 - %3").arg(item_index + 1).arg(playlist.length()).arg(active.directory));
+    if (playlist.length() > 1)
+        preload((item_index + 1) % playlist.length());
+    update();
+}
+
+//Move to the next slot, switching to the next sequence after the last slot of the active one
+void Playlist_Player::advance()
+{
+    if (active.isEmpty())
+        return;
+
+    if (position + 1 < active.content_map.length()){
+        position++;
+    } else if (playlist.length() == 1){
+        position = 0;
+    } else if (!next.isEmpty()){
+        //Assigning drops the sequence just played, so at most 2 are ever held
+        Loaded_Sequence sequence = next;
+        next = Loaded_Sequence();
+        start_sequence(sequence, next_item);
+    } else {
+        stalls++;
+        return;
+    }
+    update();
+}
+
+void Playlist_Player::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::black);
+
+    QImage image = active.image(position);
+    if (!image.isNull()){
+        QRect target(QPoint(0, 0), image.size().scaled(size(), Qt::KeepAspectRatio));
+        target.moveCenter(rect().center());
+        painter.drawImage(target, image);
+    }
+}
+
+//Closing the window stops playback and frees both sequences
+void Playlist_Player::closeEvent(QCloseEvent *event)
+{
+    stop();
+    loader->cancel();
+    loader->wait();
+    active = Loaded_Sequence();
+    next = Loaded_Sequence();
+    active_item = -1;
+    event->accept();
+}
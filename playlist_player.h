@@ -0,0 +1,49 @@
+#ifndef PLAYLIST_PLAYER_H
+#define PLAYLIST_PLAYER_H
+
+#include <QWidget>
+#include <QTimer>
+#include "playlist.h"
+#include "sequence_loader.h"
+
+/*
+ * Playlist_Player is a separate window which plays the sequences of a Playlist back to back, looping at the end, every
+ * INTER_FRAME_INTERVAL_MSECS. While a sequence plays, the next one is decoded and retimed on the Sequence_Loader, so
+ * it starts on the very next tick after the last frame. Only the playing (active) and next sequences are held in
+ * memory. If the next sequence is not ready in time, the last frame is held (a stall) until it is.
+ */
+class Playlist_Player : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit Playlist_Player(QWidget *parent = nullptr);
+    ~Playlist_Player();
+
+    Playlist playlist;
+    Sequence_Loader *loader;
+    QTimer *timer;
+    Loaded_Sequence active;
+    Loaded_Sequence next;
+    int active_item;
+    int next_item;
+    int position;
+    int stalls;
+
+    bool load_playlist(const QString &filename);
+
+public slots:
+    void play();
+    void stop();
+    void advance();
+    void sequence_ready(int generation);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void closeEvent(QCloseEvent *event);
+
+private:
+    void preload(int item_index);
+    void start_sequence(const Loaded_Sequence &sequence, int item_index);
+};
+
+#endif // PLAYLIST_PLAYER_H
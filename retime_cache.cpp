@@ -0,0 +1,135 @@
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QMutexLocker>
+#include <QDebug>
+#include "retime_cache.h"
+#include "memory_accounting.h"
+
+//'RTMC' - identifies a Retime_Cache file
+#define RETIME_CACHE_MAGIC 0x52544d43
+
+Retime_Cache::Retime_Cache()
+{
+    directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/retime";
+    accounted_bytes = 0;
+}
+
+Retime_Cache *Retime_Cache::instance()
+{
+    static Retime_Cache retime_cache;
+    return &retime_cache;
+}
+
+/*
+ * Cache key is the SHA-1 in hex of everything the calculation depends on
+ */
+QString Retime_Cache::key(const Bezier_Points &points, int frame_count, bool fixed_point)
+{
+    QByteArray key_data;
+    QDataStream stream(&key_data, QIODevice::WriteOnly);
+    stream << (qint32) RETIME_ALGORITHM_VERSION << fixed_point << (qint32) frame_count
+           << points.p0 << points.c1 << points.c2 << points.p1;
+
+    return QCryptographicHash::hash(key_data, QCryptographicHash::Sha1).toHex();
+}
+
+QString Retime_Cache::filename(const QString &key)
+{
+    return directory + "/" + key + ".retime";
+}
+
+/*
+ * Look up key in memory, then on disk. Returns false on a miss, in which case the caller calculates and store()s.
+ */
+bool Retime_Cache::load(const QString &key, QList<qreal> *degrees_list, QList<float> *skip_extend_index_list)
+{
+    QMutexLocker locker(&mutex);
+
+    if (!entries.contains(key)){
+        Retime_Cache_Entry entry;
+        if (!read_file(key, &entry))
+            return false;
+        insert_entry(key, entry);
+    }
+
+    const Retime_Cache_Entry &entry = entries[key];
+    *degrees_list = entry.degrees_list;
+    *skip_extend_index_list = entry.skip_extend_index_list;
+    return true;
+}
+
+void Retime_Cache::store(const QString &key, const QList<qreal> &degrees_list, const QList<float> &skip_extend_index_list)
+{
+    QMutexLocker locker(&mutex);
+
+    Retime_Cache_Entry entry;
+    entry.degrees_list = degrees_list;
+    entry.skip_extend_index_list = skip_extend_index_list;
+    insert_entry(key, entry);
+    write_file(key, entry);
+}
+
+//Clear the in memory entries and remove the files on disk
+void Retime_Cache::clear()
+{
+    QMutexLocker locker(&mutex);
+
+    entries.clear();
+    Memory_Accounting::instance()->release(MEMORY_CACHES, accounted_bytes);
+    accounted_bytes = 0;
+    QDir(directory).removeRecursively();
+}
+
+void Retime_Cache::insert_entry(const QString &key, const Retime_Cache_Entry &entry)
+{
+    if (entries.contains(key))
+        return;
+
+    entries.insert(key, entry);
+    qint64 bytes = key.size() * sizeof(QChar) + entry.degrees_list.length() * sizeof(qreal)
+            + entry.skip_extend_index_list.length() * sizeof(float);
+    Memory_Accounting::instance()->add(MEMORY_CACHES, bytes);
+    accounted_bytes += bytes;
+}
+
+bool Retime_Cache::read_file(const QString &key, Retime_Cache_Entry *entry)
+{
+    QFile file(filename(key));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    quint32 magic;
+    QString file_key;
+    stream >> magic >> file_key;
+    if (magic != RETIME_CACHE_MAGIC || file_key != key)
+        return false;
+
+    stream >> entry->degrees_list >> entry->skip_extend_index_list;
+    return stream.status() == QDataStream::Ok;
+}
+
+/*
+ * QSaveFile writes to a temporary file and renames it, so a concurrent reader (eg another batch job) never sees a
+ * partially written cache file
+ */
+void Retime_Cache::write_file(const QString &key, const Retime_Cache_Entry &entry)
+{
+    if (!QDir().mkpath(directory)){
+        qDebug() << "Retime Cache: unable to create" << directory;
+        return;
+    }
+
+    QSaveFile file(filename(key));
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream stream(&file);
+    stream << (quint32) RETIME_CACHE_MAGIC << key << entry.degrees_list << entry.skip_extend_index_list;
+    if (!file.commit())
+        qDebug() << "Retime Cache: unable to write" << filename(key);
+}
@@ -0,0 +1,54 @@
+#ifndef RETIME_CACHE_H
+#define RETIME_CACHE_H
+
+#include <QtGlobal>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include "bezier_points.h"
+
+/*
+ * RETIME_ALGORITHM_VERSION - part of the cache key. Increment whenever the results of calculate_bezier_degrees or
+ *                            Fixed_Point_Retimer change, so that stale cached results are never used
+ */
+#define RETIME_ALGORITHM_VERSION 1
+
+struct Retime_Cache_Entry
+{
+    QList<qreal>degrees_list;
+    QList<float>skip_extend_index_list;
+};
+
+/*
+ * Retime_Cache keeps the computed degrees_list and skip_extend_index_list of each deployed Bezier Curve, in memory and
+ * on disk (one file per key in the application cache directory). The key is a hash of the Bezier points, the number of
+ * Frames, the calculation path (floating or fixed point) and RETIME_ALGORITHM_VERSION, so an identical deploy is never
+ * recomputed, including after a restart.
+ * There is a single instance (see instance()) which may be used from any thread.
+ */
+class Retime_Cache
+{
+public:
+    static Retime_Cache *instance();
+
+    static QString key(const Bezier_Points &points, int frame_count, bool fixed_point);
+    bool load(const QString &key, QList<qreal> *degrees_list, QList<float> *skip_extend_index_list);
+    void store(const QString &key, const QList<qreal> &degrees_list, const QList<float> &skip_extend_index_list);
+    void clear();
+
+    QString directory;
+
+private:
+    Retime_Cache();
+    QMutex mutex;
+    QHash<QString, Retime_Cache_Entry>entries;
+    qint64 accounted_bytes;
+
+    QString filename(const QString &key);
+    bool read_file(const QString &key, Retime_Cache_Entry *entry);
+    void write_file(const QString &key, const Retime_Cache_Entry &entry);
+    void insert_entry(const QString &key, const Retime_Cache_Entry &entry);
+};
+
+#endif // RETIME_CACHE_H
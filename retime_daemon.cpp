@@ -0,0 +1,407 @@
+#include <QCryptographicHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtConcurrent>
+#include "retime_daemon.h"
+#include "bezier_curve.h"
+#include "easing_policy.h"
+#include "memory_accounting.h"
+#include "tile_grid.h"
+#include "frame.h"
+
+//Round value up to a multiple of alignment (a power of 2)
+static inline qsizetype align_up(qsizetype value, qsizetype alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static QJsonObject error_reply(const QString &error)
+{
+    return QJsonObject{{"ok", false}, {"error", error}};
+}
+
+Retime_Daemon::Retime_Daemon(QObject *parent)
+    : QObject{parent}
+{
+    connect(&server, SIGNAL(newConnection()), this, SLOT(new_connection()));
+}
+
+Retime_Daemon::~Retime_Daemon()
+{
+    //Sequences still being decoded are not replied to, only freed
+    for (QFutureWatcher<Sequence_Load> *watcher : qAsConst(loading)){
+        watcher->disconnect(this);
+        watcher->waitForFinished();
+        Sequence_Load load = watcher->result();
+        if (load.sequence){
+            delete load.sequence->memory;
+            delete load.sequence;
+        }
+        delete watcher;
+    }
+
+    for (Resident_Sequence *sequence : qAsConst(sequences)){
+        Memory_Accounting::instance()->release(MEMORY_DECODED_FRAMES, sequence->memory->size());
+        delete sequence->memory;
+        delete sequence;
+    }
+}
+
+/*
+ * Listen on server_name. Fails if a daemon is already listening there. A socket left behind by a daemon which did not
+ * exit cleanly is removed.
+ */
+bool Retime_Daemon::listen(const QString &server_name)
+{
+    QLocalSocket probe;
+    probe.connectToServer(server_name);
+    if (probe.waitForConnected(1000)){
+        qWarning().noquote() << "A retime daemon is already listening on" << server_name;
+        return false;
+    }
+
+    QLocalServer::removeServer(server_name);
+    if (!server.listen(server_name)){
+        qWarning().noquote() << "Unable to listen on" << server_name << server.errorString();
+        return false;
+    }
+    return true;
+}
+
+/*
+ * directory as the sequences are keyed on - the canonical path, so that eg "frames/", "./frames" and the absolute path
+ * share one resident sequence. The cleaned absolute path if it does not exist
+ */
+QString Retime_Daemon::canonical_directory(const QString &directory)
+{
+    QString canonical = QDir(directory).canonicalPath();
+    return canonical.isEmpty() ? QDir::cleanPath(QDir(directory).absolutePath()) : canonical;
+}
+
+//Shared memory key of the sequence in directory - the same in the daemon and every client
+QString Retime_Daemon::shared_memory_key(const QString &directory)
+{
+    return "bezier_easeinout_" + QCryptographicHash::hash(canonical_directory(directory).toUtf8(),
+                                                          QCryptographicHash::Sha1).toHex();
+}
+
+void Retime_Daemon::new_connection()
+{
+    while (QLocalSocket *socket = server.nextPendingConnection()){
+        connect(socket, SIGNAL(readyRead()), this, SLOT(read_requests()));
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+    }
+}
+
+//Reply to every complete request line received
+void Retime_Daemon::read_requests()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+    if (socket)
+        read_requests(socket);
+}
+
+/*
+ * Reply to the complete request lines of socket, in order. A request for a sequence which is not resident yet starts
+ * decoding it and waits in pending - the lines after it are read once it is replied to (see sequence_loaded)
+ */
+void Retime_Daemon::read_requests(QLocalSocket *socket)
+{
+    while (!is_waiting(socket) && socket->canReadLine()){
+        QJsonParseError parse_error;
+        QJsonDocument document = QJsonDocument::fromJson(socket->readLine(), &parse_error);
+        QJsonObject reply;
+        if (!document.isObject())
+            reply = error_reply("Malformed request: " + parse_error.errorString());
+        else {
+            QString directory = request_directory(document.object());
+            if (!sequences.contains(directory)){
+                pending[directory].append({socket, document.object()});
+                load_sequence(directory);
+                return;
+            }
+            reply = handle_request(document.object());
+        }
+        socket->write(QJsonDocument(reply).toJson(QJsonDocument::Compact) + "\n");
+    }
+}
+
+//True if a request of socket is waiting for its sequence to be decoded
+bool Retime_Daemon::is_waiting(QLocalSocket *socket) const
+{
+    for (const QList<Pending_Request> &requests : pending){
+        for (const Pending_Request &pending_request : requests){
+            if (pending_request.socket == socket)
+                return true;
+        }
+    }
+    return false;
+}
+
+//The directory of the sequence request is for, as sequences are keyed on
+QString Retime_Daemon::request_directory(const QJsonObject &request)
+{
+    //Relative directories are resolved by the client, see Retime_Client::open_sequence
+    return canonical_directory(request.value("directory").toString(FRAME_DIRECTORY));
+}
+
+//Reply to request, whose sequence is resident
+QJsonObject Retime_Daemon::handle_request(const QJsonObject &request)
+{
+    QString type = request.value("request").toString();
+    Resident_Sequence *sequence = sequences.value(request_directory(request));
+
+    if (type == "open"){
+        return QJsonObject{{"ok", true}, {"key", sequence->memory->key()}, {"width", sequence->size.width()},
+                           {"height", sequence->size.height()}, {"format", (int)sequence->format},
+                           {"bytes_per_line", (qint64)sequence->bytes_per_line},
+                           {"frame_bytes", (qint64)sequence->frame_bytes}, {"frame_count", sequence->frame_count}};
+    }
+
+    if (type == "retime"){
+        int frame_count = sequence->frame_count;
+        QVector<int>content_map;
+        if (request.contains("easing")){
+            bool ok;
+            Easing_Function easing = Easing_Function::from_name(request.value("easing").toString(), &ok);
+            if (!ok)
+                return error_reply("Unknown easing " + request.value("easing").toString());
+            content_map = retime_with_easing(easing, frame_count, frame_count);
+        } else {
+            Bezier_Points points = Bezier_Curve::selected_bezier_points();
+            QJsonArray coordinates = request.value("points").toArray();
+            if (coordinates.size() == 8){
+                points = {QPoint(coordinates.at(0).toInt(), coordinates.at(1).toInt()),
+                          QPoint(coordinates.at(2).toInt(), coordinates.at(3).toInt()),
+                          QPoint(coordinates.at(4).toInt(), coordinates.at(5).toInt()),
+                          QPoint(coordinates.at(6).toInt(), coordinates.at(7).toInt())};
+            } else if (!coordinates.isEmpty())
+                return error_reply("points must have 8 coordinates");
+            //Fixed point needs no begin angle from a Bezier Curve Window, and is cached by Retime_Cache
+            content_map = Bezier_Curve::compute_content_map(points, true, 0.0, frame_count);
+        }
+
+        QJsonArray content_array;
+        for (int i=0; i < content_map.length(); i++)
+            content_array.append(content_map.at(i));
+        return QJsonObject{{"ok", true}, {"content_map", content_array}};
+    }
+
+    return error_reply("Unknown request " + type);
+}
+
+/*
+ * Start decoding the sequence of directory on a worker thread, unless it is being decoded already. sequence_loaded()
+ * replies to the pending requests for it when done.
+ */
+void Retime_Daemon::load_sequence(const QString &directory)
+{
+    if (loading.contains(directory))
+        return;
+
+    QFutureWatcher<Sequence_Load> *watcher = new QFutureWatcher<Sequence_Load>(this);
+    connect(watcher, SIGNAL(finished()), this, SLOT(sequence_loaded()));
+    loading.insert(directory, watcher);
+    watcher->setFuture(QtConcurrent::run(&Retime_Daemon::decode_sequence, directory, thread()));
+}
+
+//A sequence finished decoding. Make it resident and reply to the requests waiting for it
+void Retime_Daemon::sequence_loaded()
+{
+    QFutureWatcher<Sequence_Load> *watcher = static_cast<QFutureWatcher<Sequence_Load> *>(sender());
+    QString directory = loading.key(watcher);
+    Sequence_Load load = watcher->result();
+    loading.remove(directory);
+    watcher->deleteLater();
+
+    if (load.sequence){
+        Memory_Accounting::instance()->add(MEMORY_DECODED_FRAMES, load.sequence->memory->size());
+        sequences.insert(directory, load.sequence);
+        qDebug().noquote() << "Resident" << directory << load.sequence->frame_count << "frames,"
+                           << Memory_Accounting::format_bytes(load.sequence->memory->size());
+    }
+
+    QList<Pending_Request>requests = pending.take(directory);
+    for (const Pending_Request &pending_request : requests){
+        if (!pending_request.socket)
+            continue;
+        QJsonObject reply = load.sequence ? handle_request(pending_request.request) : error_reply(load.error);
+        pending_request.socket->write(QJsonDocument(reply).toJson(QJsonDocument::Compact) + "\n");
+    }
+
+    //Carry on with the requests the clients sent meanwhile
+    for (const Pending_Request &pending_request : requests){
+        if (pending_request.socket)
+            read_requests(pending_request.socket);
+    }
+}
+
+/*
+ * Decode the sequence of directory into shared memory - run on a worker thread. The frames are counted on disk as
+ * Sequence_Loader does, and decoded one at a time straight into the shared memory, in the format QPainter draws
+ * fastest. All frames must have the same size. The shared memory is handed over to thread (the daemon's).
+ */
+Sequence_Load Retime_Daemon::decode_sequence(const QString &directory, QThread *thread)
+{
+    Sequence_Load load = {nullptr, QString()};
+
+    int frame_count = 0;
+    while (QFile::exists(Frame::frame_filename(directory, frame_count)))
+        frame_count++;
+
+    QImage first(Frame::frame_filename(directory, 0));
+    if (frame_count == 0 || first.isNull()){
+        load.error = "Unable to read " + Frame::frame_filename(directory, 0);
+        return load;
+    }
+
+    Resident_Sequence *sequence = new Resident_Sequence;
+    sequence->directory = directory;
+    sequence->size = first.size();
+    sequence->format = first.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+    sequence->bytes_per_line = align_up((qsizetype)first.width() * 4, 64);
+    sequence->frame_bytes = align_up(sequence->bytes_per_line * first.height(), 64);
+    sequence->frame_count = frame_count;
+    sequence->memory = new QSharedMemory(shared_memory_key(directory));
+
+    qsizetype total_bytes = sequence->frame_bytes * sequence->frame_count;
+    bool created = sequence->memory->create(total_bytes);
+    if (!created && sequence->memory->error() == QSharedMemory::AlreadyExists){
+        //Left behind by a daemon which did not exit cleanly (Unix) - attaching and detaching removes it
+        if (sequence->memory->attach())
+            sequence->memory->detach();
+        created = sequence->memory->create(total_bytes);
+    }
+    if (!created){
+        load.error = "Unable to create shared memory: " + sequence->memory->errorString();
+        delete sequence->memory;
+        delete sequence;
+        return load;
+    }
+
+    bool loaded = true;
+    sequence->memory->lock();
+    for (int i=0; i < sequence->frame_count && loaded; i++){
+        QImage decoded = (i == 0) ? first : QImage(Frame::frame_filename(directory, i));
+        QImage frame((uchar *)sequence->memory->data() + i * sequence->frame_bytes, sequence->size.width(),
+                     sequence->size.height(), sequence->bytes_per_line, sequence->format);
+        loaded = decoded.size() == sequence->size && Tile_Grid::copy_into(decoded.convertToFormat(sequence->format), &frame);
+        if (!loaded)
+            load.error = "Unable to read " + Frame::frame_filename(directory, i) + " (missing or of another size)";
+    }
+    sequence->memory->unlock();
+
+    if (!loaded){
+        delete sequence->memory;
+        delete sequence;
+        return load;
+    }
+
+    sequence->memory->moveToThread(thread);
+    load.sequence = sequence;
+    return load;
+}
+
+Retime_Client::Retime_Client()
+{
+    frame_count = 0;
+    format = QImage::Format_Invalid;
+    bytes_per_line = 0;
+    frame_bytes = 0;
+}
+
+Retime_Client::~Retime_Client()
+{
+    if (memory.isAttached())
+        memory.detach();
+}
+
+bool Retime_Client::connect_to_daemon(const QString &server_name)
+{
+    socket.connectToServer(server_name);
+    if (!socket.waitForConnected(RETIME_DAEMON_TIMEOUT_MSECS)){
+        error = "Unable to connect to the retime daemon: " + socket.errorString();
+        return false;
+    }
+    return true;
+}
+
+//Send request and wait for the reply. False if there is no reply or it is not ok (see error)
+bool Retime_Client::request(const QJsonObject &request, QJsonObject *reply)
+{
+    socket.write(QJsonDocument(request).toJson(QJsonDocument::Compact) + "\n");
+    if (!socket.waitForBytesWritten(RETIME_DAEMON_TIMEOUT_MSECS)){
+        error = "Unable to send to the retime daemon: " + socket.errorString();
+        return false;
+    }
+    while (!socket.canReadLine()){
+        if (!socket.waitForReadyRead(RETIME_DAEMON_TIMEOUT_MSECS)){
+            error = "No reply from the retime daemon: " + socket.errorString();
+            return false;
+        }
+    }
+
+    *reply = QJsonDocument::fromJson(socket.readLine()).object();
+    if (!reply->value("ok").toBool()){
+        error = reply->value("error").toString("Malformed reply");
+        return false;
+    }
+    return true;
+}
+
+//Have the daemon make the sequence in directory resident and attach to it
+bool Retime_Client::open_sequence(const QString &directory)
+{
+    QJsonObject reply;
+    //Sent absolute, as the daemon's working directory is not the client's
+    QString absolute_directory = QFileInfo(directory).absoluteFilePath();
+    if (!request({{"request", "open"}, {"directory", absolute_directory}}, &reply))
+        return false;
+
+    if (memory.isAttached())
+        memory.detach();
+    memory.setKey(reply.value("key").toString());
+    if (!memory.attach(QSharedMemory::ReadOnly)){
+        error = "Unable to attach to shared memory: " + memory.errorString();
+        return false;
+    }
+
+    this->directory = absolute_directory;
+    size = QSize(reply.value("width").toInt(), reply.value("height").toInt());
+    format = (QImage::Format)reply.value("format").toInt();
+    bytes_per_line = reply.value("bytes_per_line").toVariant().toLongLong();
+    frame_bytes = reply.value("frame_bytes").toVariant().toLongLong();
+    frame_count = reply.value("frame_count").toInt();
+    return true;
+}
+
+//Content map of the open sequence retimed with the named easing, or the selected Bezier Curve if easing is empty
+bool Retime_Client::retime(const QString &easing, QVector<int> *content_map)
+{
+    QJsonObject retime_request{{"request", "retime"}, {"directory", directory}};
+    if (!easing.isEmpty())
+        retime_request.insert("easing", easing);
+
+    QJsonObject reply;
+    if (!request(retime_request, &reply))
+        return false;
+
+    content_map->clear();
+    QJsonArray content_array = reply.value("content_map").toArray();
+    for (int i=0; i < content_array.size(); i++)
+        content_map->append(qBound(0, content_array.at(i).toInt(), frame_count - 1));
+    return true;
+}
+
+//Frame index of the open sequence, read only, using the shared memory directly
+QImage Retime_Client::frame(int index) const
+{
+    if (!memory.isAttached() || index < 0 || index >= frame_count)
+        return QImage();
+    return QImage((const uchar *)memory.constData() + index * frame_bytes, size.width(), size.height(), bytes_per_line,
+                  format);
+}
@@ -0,0 +1,133 @@
+#ifndef RETIME_DAEMON_H
+#define RETIME_DAEMON_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QImage>
+#include <QJsonObject>
+#include <QList>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+#include <QSharedMemory>
+#include <QVector>
+
+/*
+ * RETIME_DAEMON_SERVER_NAME - local socket name the daemon listens on (see QLocalServer)
+ * RETIME_DAEMON_TIMEOUT_MSECS - how long a client waits for the daemon to connect or reply
+ */
+#define RETIME_DAEMON_SERVER_NAME "bezier_easeinout_retime"
+#define RETIME_DAEMON_TIMEOUT_MSECS 30000
+
+/*
+ * A sequence kept resident by the daemon. The frames are decoded once into one shared memory segment, frame_bytes
+ * apart, which every client attaches to read only.
+ */
+struct Resident_Sequence
+{
+    QString directory;
+    QSharedMemory *memory;
+    QSize size;
+    QImage::Format format;
+    qsizetype bytes_per_line;
+    qsizetype frame_bytes;
+    int frame_count;
+};
+
+//Result of decoding a sequence on a worker thread - the sequence, or nullptr and the error
+struct Sequence_Load
+{
+    Resident_Sequence *sequence;
+    QString error;
+};
+
+//A request waiting for its sequence to be decoded, and the socket to reply on
+struct Pending_Request
+{
+    QPointer<QLocalSocket> socket;
+    QJsonObject request;
+};
+
+/*
+ * Retime_Daemon (--daemon) keeps decoded sequences resident and serves retiming requests over a local socket, so many
+ * processes share one decode of each sequence and one Retime_Cache.
+ *
+ * Requests and replies are JSON objects, one per line:
+ *   {"request": "open", "directory": d}
+ *       Decode (once) the sequence in directory d into shared memory. The reply has the shared memory "key" and the
+ *       layout of the frames in it: "width", "height", "format", "bytes_per_line", "frame_bytes", "frame_count"
+ *   {"request": "retime", "directory": d, "easing": name}            (easing as Easing_Function::from_name)
+ *   {"request": "retime", "directory": d, "points": [8 coordinates]} (Bezier points p0, c1, c2, p1)
+ *       The "content_map" - frame of the sequence to show at each index. Without easing or points, the selected
+ *       Bezier Curve
+ * Every reply has "ok", and "error" when not ok.
+ *
+ * A sequence is decoded on a worker thread, so the daemon keeps serving other clients meanwhile. The requests of one
+ * client are replied in order - its later requests wait until the sequence it asked for is decoded.
+ *
+ * Pixels are never sent over the socket - clients read the frames straight out of the shared memory (see
+ * Retime_Client).
+ */
+class Retime_Daemon : public QObject
+{
+    Q_OBJECT
+public:
+    explicit Retime_Daemon(QObject *parent = nullptr);
+    ~Retime_Daemon();
+
+    bool listen(const QString &server_name = RETIME_DAEMON_SERVER_NAME);
+    static QString canonical_directory(const QString &directory);
+    static QString shared_memory_key(const QString &directory);
+
+private slots:
+    void new_connection();
+    void read_requests();
+    void sequence_loaded();
+
+private:
+    QLocalServer server;
+    QHash<QString, Resident_Sequence *>sequences;
+    QHash<QString, QFutureWatcher<Sequence_Load> *>loading;
+    QHash<QString, QList<Pending_Request>>pending;
+
+    void read_requests(QLocalSocket *socket);
+    bool is_waiting(QLocalSocket *socket) const;
+    static QString request_directory(const QJsonObject &request);
+    QJsonObject handle_request(const QJsonObject &request);
+    void load_sequence(const QString &directory);
+    static Sequence_Load decode_sequence(const QString &directory, QThread *thread);
+};
+
+/*
+ * Retime_Client talks to a Retime_Daemon. frame() returns an image using the daemon's shared memory directly - no
+ * pixels are copied. The images are valid while the client stays attached (until it is destroyed or opens another
+ * sequence).
+ */
+class Retime_Client
+{
+public:
+    Retime_Client();
+    ~Retime_Client();
+
+    int frame_count;
+    QString error;
+
+    bool connect_to_daemon(const QString &server_name = RETIME_DAEMON_SERVER_NAME);
+    bool open_sequence(const QString &directory);
+    bool retime(const QString &easing, QVector<int> *content_map);
+    QImage frame(int index) const;
+
+private:
+    QLocalSocket socket;
+    QSharedMemory memory;
+    QString directory;
+    QSize size;
+    QImage::Format format;
+    qsizetype bytes_per_line;
+    qsizetype frame_bytes;
+
+    bool request(const QJsonObject &request, QJsonObject *reply);
+};
+
+#endif // RETIME_DAEMON_H
@@ -0,0 +1,79 @@
+#ifndef RETIME_TIMELINE_H
+#define RETIME_TIMELINE_H
+
+#include <QVector>
+
+/*
+ * Retime_Timeline is what is shown at each index (slot) of the retimed (new) Frames list. The metadata is kept as
+ * structure of arrays - one compact array per field - so that the retiming loops scan contiguous ints rather than
+ * widgets or interleaved structs.
+ *   src_index     - index of the slot the contents were copied from
+ *   content_index - index of the original Frame (frame_list) whose image is actually shown. Differs from src_index when
+ *                   the contents are copied from a slot that had itself been overwritten
+ *   delta         - skip/extend index which caused the copy
+ *   overwritten   - contents have been copied from another slot (0 or 1)
+ */
+struct Retime_Timeline
+{
+    QVector<int>src_index;
+    QVector<int>content_index;
+    QVector<int>delta;
+    QVector<quint8>overwritten;
+
+    Retime_Timeline() {}
+    explicit Retime_Timeline(int frame_count)
+        : src_index(frame_count), content_index(frame_count), delta(frame_count), overwritten(frame_count)
+    {
+    }
+
+    int length() const { return content_index.length(); }
+    bool isEmpty() const { return content_index.isEmpty(); }
+
+    void clear()
+    {
+        src_index.clear();
+        content_index.clear();
+        delta.clear();
+        overwritten.clear();
+    }
+
+    void set_slot(int index, int src, int content, int slot_delta, bool slot_overwritten)
+    {
+        src_index[index] = src;
+        content_index[index] = content;
+        delta[index] = slot_delta;
+        overwritten[index] = slot_overwritten ? 1 : 0;
+    }
+};
+
+//Timeline where every slot shows its own original Frame - ie before any Bezier Curve is deployed
+inline Retime_Timeline identity_timeline(int frame_count)
+{
+    Retime_Timeline timeline(frame_count);
+    for (int i=0; i < frame_count; i++)
+        timeline.set_slot(i, i, i, 0, false);
+    return timeline;
+}
+
+/*
+ * Timeline from a content map - ie the original Frame to show at each slot, as produced by Keyframe_Timeline::retime.
+ * delta is the jump in original Frames from the previous slot (+N skip, 0 extend)
+ */
+inline Retime_Timeline timeline_from_content_map(const QVector<int> &content_map)
+{
+    Retime_Timeline timeline(content_map.length());
+    for (int i=0; i < content_map.length(); i++){
+        int content_index = content_map.at(i);
+        int delta = (i == 0) ? content_index : content_index - content_map.at(i-1);
+        timeline.set_slot(i, content_index, content_index, delta, content_index != i);
+    }
+    return timeline;
+}
+
+//Content map of timeline - ie the original Frame shown at each slot. The inverse of timeline_from_content_map
+inline QVector<int> content_map_from_timeline(const Retime_Timeline &timeline)
+{
+    return timeline.content_index;
+}
+
+#endif // RETIME_TIMELINE_H
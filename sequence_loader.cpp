@@ -0,0 +1,85 @@
+#include <QFile>
+#include "sequence_loader.h"
+#include "bezier_curve.h"
+#include "easing_policy.h"
+#include "frame.h"
+
+Sequence_Loader::Sequence_Loader(QObject *parent)
+    : QThread{parent}
+{
+    generation = 0;
+    run_generation = 0;
+    item_index = -1;
+}
+
+//Start loading item. Call from the GUI thread while the loader is not running
+void Sequence_Loader::start_load(const Playlist_Item &item, int item_index)
+{
+    this->item = item;
+    this->item_index = item_index;
+    sequence = Loaded_Sequence();
+    error.clear();
+    cancelled.storeRelease(0);
+
+    generation++;
+    run_generation = generation;
+    start();
+}
+
+//A load already complete, whose sequence_ready() may still be queued, is left stale too. Call from the GUI thread
+void Sequence_Loader::cancel()
+{
+    cancelled.storeRelease(1);
+    generation++;
+}
+
+bool Sequence_Loader::is_cancelled()
+{
+    return cancelled.loadAcquire() != 0;
+}
+
+/*
+ * Decode the sequence into one Frame_Arena, in the format QPainter draws fastest, then retime it with the item's
+ * curve. Each frame is decoded and stored before the next is read, so only one decoded frame is held outside the arena.
+ */
+void Sequence_Loader::run()
+{
+    int frame_count = 0;
+    while (QFile::exists(Frame::frame_filename(item.directory, frame_count)))
+        frame_count++;
+
+    QImage first(Frame::frame_filename(item.directory, 0));
+    if (first.isNull()){
+        error = "Unable to read " + Frame::frame_filename(item.directory, 0);
+        emit sequence_ready(run_generation);
+        return;
+    }
+
+    Loaded_Sequence loaded;
+    loaded.directory = item.directory;
+    loaded.arena.reset(new Frame_Arena(frame_count, first.size(), first.hasAlphaChannel() ?
+                                           QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32));
+    for (int i=0; i < frame_count; i++){
+        if (is_cancelled())
+            return;
+        QImage image = (i == 0) ? first : QImage(Frame::frame_filename(item.directory, i));
+        loaded.source_images.append(loaded.arena->is_valid() ? loaded.arena->store(i, image) : image);
+    }
+
+    if (!item.easing.isEmpty()){
+        bool ok;
+        Easing_Function easing = Easing_Function::from_name(item.easing, &ok);
+        if (!ok){
+            error = "Unknown easing " + item.easing;
+            emit sequence_ready(run_generation);
+            return;
+        }
+        loaded.content_map = retime_with_easing(easing, frame_count, frame_count);
+    } else
+        loaded.content_map = Bezier_Curve::compute_content_map(item.points, true, 0.0, frame_count);
+    if (is_cancelled())
+        return;
+
+    sequence = loaded;
+    emit sequence_ready(run_generation);
+}
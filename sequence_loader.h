@@ -0,0 +1,60 @@
+#ifndef SEQUENCE_LOADER_H
+#define SEQUENCE_LOADER_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QImage>
+#include <QSharedPointer>
+#include <QVector>
+#include "frame_arena.h"
+#include "playlist.h"
+
+/*
+ * Loaded_Sequence is a Playlist_Item decoded and retimed, ready to play. The decoded frames are held in arena;
+ * content_map is the source frame to show at each slot. Dropping the Loaded_Sequence frees all its pixels at once.
+ */
+struct Loaded_Sequence
+{
+    QString directory;
+    QSharedPointer<Frame_Arena>arena;
+    QVector<QImage>source_images;
+    QVector<int>content_map;
+
+    bool isEmpty() const { return content_map.isEmpty(); }
+    QImage image(int slot) const { return source_images.value(content_map.value(slot, -1)); }
+};
+
+/*
+ * Sequence_Loader decodes and retimes a Playlist_Item on its own thread, so that the next sequence of a playlist is
+ * ready before the current one ends. As Deploy_Worker, sequence_ready() is emitted with the generation of the load
+ * when complete, and a cancelled load emits nothing.
+ */
+class Sequence_Loader : public QThread
+{
+    Q_OBJECT
+public:
+    explicit Sequence_Loader(QObject *parent = nullptr);
+
+    void start_load(const Playlist_Item &item, int item_index);
+    void cancel();
+    bool is_cancelled();
+
+    //Valid once sequence_ready() is emitted with the current generation. cancel() moves generation on
+    int generation;
+    int item_index;
+    Loaded_Sequence sequence;
+    QString error;
+
+signals:
+    void sequence_ready(int generation);
+
+protected:
+    void run() override;
+
+private:
+    Playlist_Item item;
+    int run_generation;
+    QAtomicInt cancelled;
+};
+
+#endif // SEQUENCE_LOADER_H
@@ -0,0 +1,412 @@
+#include "simd_kernels.h"
+#include <cstring>
+
+/*
+ * AVX2 kernels are built for AVX2 on their own (SIMD_AVX2_TARGET) whatever the rest is built for, and run only on
+ * CPUs which have it (see cpu_has_avx2)
+ */
+#if defined(__AVX2__)
+#define SIMD_AVX2
+#define SIMD_AVX2_TARGET
+#include <immintrin.h>
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_AVX2
+#define SIMD_AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define SIMD_AVX2
+#define SIMD_AVX2_TARGET
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(SIMD_AVX2)
+//Whether the CPU, and the OS, support AVX2. Checked once
+static bool cpu_has_avx2()
+{
+#if defined(__AVX2__)
+    return true;
+#elif defined(_MSC_VER)
+    static const bool supported = [] {
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+        //AVX, and the OS saves the AVX registers (OSXSAVE, XCR0)
+        __cpuid(info, 1);
+        if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6)
+            return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    }();
+    return supported;
+#else
+    static const bool supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return supported;
+#endif
+}
+#endif
+
+quint64 sad_u8(const uchar *a, const uchar *b, qsizetype length)
+{
+    quint64 sad = 0;
+    qsizetype i = 0;
+
+#if defined(SIMD_SSE2)
+    //_mm_sad_epu8 sums 8 absolute differences into each 64 bit half
+    __m128i sum = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16){
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(va, vb));
+    }
+    quint64 halves[2];
+    _mm_storeu_si128((__m128i *)halves, sum);
+    sad = halves[0] + halves[1];
+#elif defined(SIMD_NEON)
+    //Absolute differences widened and accumulated pairwise. Flushed every 256 iterations before 32 bits can overflow
+    uint32x4_t sum = vdupq_n_u32(0);
+    int iterations = 0;
+    for (; i + 16 <= length; i += 16){
+        uint8x16_t difference = vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+        sum = vpadalq_u16(sum, vpaddlq_u8(difference));
+        if (++iterations == 256){
+            sad += vgetq_lane_u32(sum, 0) + (quint64)vgetq_lane_u32(sum, 1) + vgetq_lane_u32(sum, 2) + vgetq_lane_u32(sum, 3);
+            sum = vdupq_n_u32(0);
+            iterations = 0;
+        }
+    }
+    sad += vgetq_lane_u32(sum, 0) + (quint64)vgetq_lane_u32(sum, 1) + vgetq_lane_u32(sum, 2) + vgetq_lane_u32(sum, 3);
+#endif
+
+    for (; i < length; i++)
+        sad += (a[i] > b[i]) ? (a[i] - b[i]) : (b[i] - a[i]);
+    return sad;
+}
+
+qint64 image_sad(const QImage &a, const QImage &b)
+{
+    if (a.size() != b.size() || a.format() != b.format() || a.isNull())
+        return -1;
+
+    //Only the pixels of each scanline, not any padding
+    qsizetype line_bytes = (qsizetype)a.width() * a.depth() / 8;
+    qint64 sad = 0;
+    for (int y=0; y < a.height(); y++)
+        sad += sad_u8(a.constScanLine(y), b.constScanLine(y), line_bytes);
+    return sad;
+}
+
+qreal image_difference(const QImage &a, const QImage &b)
+{
+    /*
+     * Palette indexes are only comparable through their colours, and images of different formats (eg one converted
+     * to premultiplied for display, see MainWindow::prepare_frame_for_display) through one format
+     */
+    if (a.format() == QImage::Format_Indexed8 || b.format() == QImage::Format_Indexed8
+            || (a.format() != b.format() && a.size() == b.size() && !a.isNull()))
+        return image_difference(a.convertToFormat(QImage::Format_ARGB32), b.convertToFormat(QImage::Format_ARGB32));
+
+    qint64 sad = image_sad(a, b);
+    if (sad < 0)
+        return -1.0;
+
+    qint64 bytes = (qint64)a.width() * a.height() * a.depth() / 8;
+    if (bytes == 0)
+        return 0.0;
+    return (qreal)sad / bytes;
+}
+
+/*
+ * A palette lookup per pixel. AVX2 gathers 8 palette entries per instruction, on CPUs which have it; there is no
+ * gather in SSE2 or NEON, so the fallback is a lookup unrolled by 4
+ */
+#if defined(SIMD_AVX2)
+//8 pixels at a time with AVX2. Returns the number of pixels expanded, a multiple of 8
+static SIMD_AVX2_TARGET qsizetype expand_palette_avx2(const uchar *indexes, const QRgb *palette, QRgb *dst,
+                                                      qsizetype length)
+{
+    qsizetype i = 0;
+    for (; i + 8 <= length; i += 8){
+        __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(indexes + i)));
+        __m256i colour = _mm256_i32gather_epi32((const int *)palette, index, 4);
+        _mm256_storeu_si256((__m256i *)(dst + i), colour);
+    }
+    return i;
+}
+#endif
+
+void expand_palette(const uchar *indexes, const QRgb *palette, QRgb *dst, qsizetype length)
+{
+    qsizetype i = 0;
+
+#if defined(SIMD_AVX2)
+    if (cpu_has_avx2())
+        i = expand_palette_avx2(indexes, palette, dst, length);
+#endif
+
+    for (; i + 4 <= length; i += 4){
+        dst[i] = palette[indexes[i]];
+        dst[i+1] = palette[indexes[i+1]];
+        dst[i+2] = palette[indexes[i+2]];
+        dst[i+3] = palette[indexes[i+3]];
+    }
+    for (; i < length; i++)
+        dst[i] = palette[indexes[i]];
+}
+
+/*
+ * Full range BT.601 luma Y = (77R + 150G + 29B + 128) >> 8. The coefficients sum to 256 so Y never exceeds 255.
+ * SSE2 converts 4 pixels per iteration (multiply-add of the 16 bit channels), NEON 8 (de-interleaving load).
+ */
+void rgb_to_luma(const QRgb *src, uchar *dst, qsizetype length)
+{
+    qsizetype i = 0;
+
+#if defined(SIMD_SSE2)
+    //QRgb is 0xAARRGGBB - bytes B, G, R, A in memory
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i coefficients = _mm_setr_epi16(29, 150, 77, 0, 29, 150, 77, 0);
+    const __m128i rounding = _mm_set1_epi32(128);
+    for (; i + 4 <= length; i += 4){
+        __m128i pixels = _mm_loadu_si128((const __m128i *)(src + i));
+        //(29B + 150G, 77R) per pixel, then the 2 halves summed into lanes 0 and 2
+        __m128i low = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), coefficients);
+        __m128i high = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), coefficients);
+        low = _mm_add_epi32(low, _mm_srli_epi64(low, 32));
+        high = _mm_add_epi32(high, _mm_srli_epi64(high, 32));
+        __m128i luma = _mm_unpacklo_epi64(_mm_shuffle_epi32(low, _MM_SHUFFLE(3, 3, 2, 0)),
+                                          _mm_shuffle_epi32(high, _MM_SHUFFLE(3, 3, 2, 0)));
+        luma = _mm_srli_epi32(_mm_add_epi32(luma, rounding), 8);
+        luma = _mm_packs_epi32(luma, luma);
+        luma = _mm_packus_epi16(luma, luma);
+        int bytes = _mm_cvtsi128_si32(luma);
+        memcpy(dst + i, &bytes, 4);
+    }
+#elif defined(SIMD_NEON)
+    for (; i + 8 <= length; i += 8){
+        uint8x8x4_t pixels = vld4_u8((const uint8_t *)(src + i));
+        uint16x8_t luma = vmull_u8(pixels.val[2], vdup_n_u8(77));
+        luma = vmlal_u8(luma, pixels.val[1], vdup_n_u8(150));
+        luma = vmlal_u8(luma, pixels.val[0], vdup_n_u8(29));
+        vst1_u8(dst + i, vrshrn_n_u16(luma, 8));
+    }
+#endif
+
+    for (; i < length; i++){
+        QRgb pixel = src[i];
+        dst[i] = (uchar)((77 * qRed(pixel) + 150 * qGreen(pixel) + 29 * qBlue(pixel) + 128) >> 8);
+    }
+}
+
+/*
+ * Full range BT.601 chroma of each 2x2 block of row0 and row1 (row1 may be row0 for an odd last row), from the sums
+ * of the block's 4 pixels. A last odd column is counted twice. Chroma is a quarter of the pixels of luma, so it is
+ * not vectorized.
+ */
+void rgb_to_chroma_420(const QRgb *row0, const QRgb *row1, uchar *u, uchar *v, qsizetype width)
+{
+    for (qsizetype x=0; x < width; x += 2){
+        qsizetype next = (x + 1 < width) ? x + 1 : x;
+        QRgb pixels[4] = {row0[x], row0[next], row1[x], row1[next]};
+        int red = 0, green = 0, blue = 0;
+        for (int i=0; i < 4; i++){
+            red += qRed(pixels[i]);
+            green += qGreen(pixels[i]);
+            blue += qBlue(pixels[i]);
+        }
+        //Offset by 128 << 10 before the shift so that it is of a positive number
+        int chroma_u = (-43 * red - 85 * green + 128 * blue + (128 << 10) + 512) >> 10;
+        int chroma_v = (128 * red - 107 * green - 21 * blue + (128 << 10) + 512) >> 10;
+        u[x / 2] = (uchar)qMin(chroma_u, 255);
+        v[x / 2] = (uchar)qMin(chroma_v, 255);
+    }
+}
+
+/*
+ * acc[i] += src[i] * weight. 16 bit products and sums - the weights of all frames accumulated must sum to at most 256
+ * so that no sum can exceed 255 * 256
+ */
+void accumulate_weighted(const uchar *src, quint16 weight, quint16 *acc, qsizetype length)
+{
+    qsizetype i = 0;
+
+#if defined(SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weights = _mm_set1_epi16((short)weight);
+    for (; i + 16 <= length; i += 16){
+        __m128i bytes = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i low = _mm_loadu_si128((const __m128i *)(acc + i));
+        __m128i high = _mm_loadu_si128((const __m128i *)(acc + i + 8));
+        low = _mm_add_epi16(low, _mm_mullo_epi16(_mm_unpacklo_epi8(bytes, zero), weights));
+        high = _mm_add_epi16(high, _mm_mullo_epi16(_mm_unpackhi_epi8(bytes, zero), weights));
+        _mm_storeu_si128((__m128i *)(acc + i), low);
+        _mm_storeu_si128((__m128i *)(acc + i + 8), high);
+    }
+#elif defined(SIMD_NEON)
+    const uint16x8_t weights = vdupq_n_u16(weight);
+    for (; i + 16 <= length; i += 16){
+        uint8x16_t bytes = vld1q_u8(src + i);
+        uint16x8_t low = vmlaq_u16(vld1q_u16(acc + i), vmovl_u8(vget_low_u8(bytes)), weights);
+        uint16x8_t high = vmlaq_u16(vld1q_u16(acc + i + 8), vmovl_u8(vget_high_u8(bytes)), weights);
+        vst1q_u16(acc + i, low);
+        vst1q_u16(acc + i + 8, high);
+    }
+#endif
+
+    for (; i < length; i++)
+        acc[i] = (quint16)(acc[i] + src[i] * weight);
+}
+
+//dst[i] = acc[i] / 256 rounded, ie the weighted average of the frames accumulated with weights summing to 256
+void resolve_accumulated(const quint16 *acc, uchar *dst, qsizetype length)
+{
+    qsizetype i = 0;
+
+#if defined(SIMD_SSE2)
+    //acc + 128 cannot overflow 16 bits (at most 255 * 256 + 128)
+    const __m128i rounding = _mm_set1_epi16(128);
+    for (; i + 16 <= length; i += 16){
+        __m128i low = _mm_srli_epi16(_mm_add_epi16(_mm_loadu_si128((const __m128i *)(acc + i)), rounding), 8);
+        __m128i high = _mm_srli_epi16(_mm_add_epi16(_mm_loadu_si128((const __m128i *)(acc + i + 8)), rounding), 8);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(low, high));
+    }
+#elif defined(SIMD_NEON)
+    for (; i + 16 <= length; i += 16){
+        uint8x8_t low = vrshrn_n_u16(vld1q_u16(acc + i), 8);
+        uint8x8_t high = vrshrn_n_u16(vld1q_u16(acc + i + 8), 8);
+        vst1q_u8(dst + i, vcombine_u8(low, high));
+    }
+#endif
+
+    for (; i < length; i++)
+        dst[i] = (uchar)((acc[i] + 128) >> 8);
+}
+
+//(sum + half) >> RESAMPLE_WEIGHT_BITS clamped to a byte - the rounding every path of the resample kernels uses
+static inline uchar resample_round(int sum)
+{
+    int value = (sum + (1 << (RESAMPLE_WEIGHT_BITS - 1))) >> RESAMPLE_WEIGHT_BITS;
+    return (uchar)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+void resample_vertical(const uchar *const *rows, const qint16 *weights, int taps, uchar *dst, qsizetype length)
+{
+    qsizetype i = 0;
+
+#if defined(SIMD_SSE2)
+    //Rows are taken in pairs so that _mm_madd_epi16 multiplies and adds 2 taps at once
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rounding = _mm_set1_epi32(1 << (RESAMPLE_WEIGHT_BITS - 1));
+    for (; i + 8 <= length; i += 8){
+        __m128i low = _mm_setzero_si128();
+        __m128i high = _mm_setzero_si128();
+        for (int k=0; k < taps; k += 2){
+            __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(rows[k] + i)), zero);
+            __m128i b = zero;
+            int weight_b = 0;
+            if (k + 1 < taps){
+                b = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(rows[k+1] + i)), zero);
+                weight_b = weights[k+1];
+            }
+            __m128i pair = _mm_set1_epi32((int)(((quint32)(quint16)weight_b << 16) | (quint16)weights[k]));
+            low = _mm_add_epi32(low, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), pair));
+            high = _mm_add_epi32(high, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), pair));
+        }
+        low = _mm_srai_epi32(_mm_add_epi32(low, rounding), RESAMPLE_WEIGHT_BITS);
+        high = _mm_srai_epi32(_mm_add_epi32(high, rounding), RESAMPLE_WEIGHT_BITS);
+        __m128i words = _mm_packs_epi32(low, high);
+        _mm_storel_epi64((__m128i *)(dst + i), _mm_packus_epi16(words, words));
+    }
+#elif defined(SIMD_NEON)
+    const int32x4_t rounding = vdupq_n_s32(1 << (RESAMPLE_WEIGHT_BITS - 1));
+    for (; i + 8 <= length; i += 8){
+        int32x4_t low = vdupq_n_s32(0);
+        int32x4_t high = vdupq_n_s32(0);
+        for (int k=0; k < taps; k++){
+            int16x8_t values = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(rows[k] + i)));
+            low = vmlal_n_s16(low, vget_low_s16(values), weights[k]);
+            high = vmlal_n_s16(high, vget_high_s16(values), weights[k]);
+        }
+        low = vshrq_n_s32(vaddq_s32(low, rounding), RESAMPLE_WEIGHT_BITS);
+        high = vshrq_n_s32(vaddq_s32(high, rounding), RESAMPLE_WEIGHT_BITS);
+        vst1_u8(dst + i, vqmovun_s16(vcombine_s16(vqmovn_s32(low), vqmovn_s32(high))));
+    }
+#endif
+
+    for (; i < length; i++){
+        int sum = 0;
+        for (int k=0; k < taps; k++)
+            sum += rows[k][i] * weights[k];
+        dst[i] = resample_round(sum);
+    }
+}
+
+void resample_horizontal(const QRgb *src, QRgb *dst, qsizetype dst_width, const int *offsets, const qint16 *weights,
+                         int taps)
+{
+    qsizetype x = 0;
+
+#if defined(SIMD_SSE2)
+    //The 4 channels of 2 neighbouring pixels interleaved, so _mm_madd_epi16 applies 2 taps to all channels at once
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rounding = _mm_set1_epi32(1 << (RESAMPLE_WEIGHT_BITS - 1));
+    for (; x < dst_width; x++){
+        const QRgb *pixels = src + offsets[x];
+        const qint16 *pixel_weights = weights + x * taps;
+        __m128i sum = _mm_setzero_si128();
+        for (int k=0; k < taps; k += 2){
+            __m128i a = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)pixels[k]), zero);
+            __m128i b = zero;
+            int weight_b = 0;
+            if (k + 1 < taps){
+                b = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)pixels[k+1]), zero);
+                weight_b = pixel_weights[k+1];
+            }
+            __m128i pair = _mm_set1_epi32((int)(((quint32)(quint16)weight_b << 16) | (quint16)pixel_weights[k]));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), pair));
+        }
+        sum = _mm_srai_epi32(_mm_add_epi32(sum, rounding), RESAMPLE_WEIGHT_BITS);
+        __m128i words = _mm_packs_epi32(sum, sum);
+        dst[x] = (QRgb)_mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+    }
+#elif defined(SIMD_NEON)
+    const int32x4_t rounding = vdupq_n_s32(1 << (RESAMPLE_WEIGHT_BITS - 1));
+    for (; x < dst_width; x++){
+        const QRgb *pixels = src + offsets[x];
+        const qint16 *pixel_weights = weights + x * taps;
+        int32x4_t sum = vdupq_n_s32(0);
+        for (int k=0; k < taps; k++){
+            int16x4_t channels = vget_low_s16(vreinterpretq_s16_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(pixels[k])))));
+            sum = vmlal_n_s16(sum, channels, pixel_weights[k]);
+        }
+        sum = vshrq_n_s32(vaddq_s32(sum, rounding), RESAMPLE_WEIGHT_BITS);
+        int16x4_t words = vqmovn_s32(sum);
+        dst[x] = vget_lane_u32(vreinterpret_u32_u8(vqmovun_s16(vcombine_s16(words, words))), 0);
+    }
+#endif
+
+    for (; x < dst_width; x++){
+        const QRgb *pixels = src + offsets[x];
+        const qint16 *pixel_weights = weights + x * taps;
+        QRgb pixel = 0;
+        for (int channel=0; channel < 4; channel++){
+            int sum = 0;
+            for (int k=0; k < taps; k++)
+                sum += (int)((pixels[k] >> (channel * 8)) & 0xff) * pixel_weights[k];
+            pixel |= (QRgb)resample_round(sum) << (channel * 8);
+        }
+        dst[x] = pixel;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <QtGlobal>
+#include <QImage>
+
+/*
+ * Pixel kernels vectorized with SSE2 (x86) or NEON (ARM) when the compiler targets them, with a plain C++ fallback
+ * otherwise. AVX2 kernels are picked at runtime on CPUs which have AVX2. All kernels give identical results on every
+ * path.
+ */
+
+//Sum of absolute differences of length bytes of a and b
+quint64 sad_u8(const uchar *a, const uchar *b, qsizetype length);
+
+//Sum of absolute differences of all channels of 2 images of the same size and format. -1 if they differ in size/format
+qint64 image_sad(const QImage &a, const QImage &b);
+
+/*
+ * Mean absolute difference per channel (0 to 255) of 2 images, compared as ARGB32 if their formats differ. -1 if they
+ * differ in size
+ */
+qreal image_difference(const QImage &a, const QImage &b);
+
+//Expand length 8 bit palette indexes to 32 bit colours. palette must have 256 entries
+void expand_palette(const uchar *indexes, const QRgb *palette, QRgb *dst, qsizetype length);
+
+//Full range BT.601 luma of length pixels
+void rgb_to_luma(const QRgb *src, uchar *dst, qsizetype length);
+
+//Full range BT.601 chroma subsampled 2x2 (4:2:0) of 2 rows of width pixels, (width+1)/2 values each to u and v
+void rgb_to_chroma_420(const QRgb *row0, const QRgb *row1, uchar *u, uchar *v, qsizetype width);
+
+//acc[i] += src[i] * weight for length bytes. The weights accumulated into acc must sum to at most 256
+void accumulate_weighted(const uchar *src, quint16 weight, quint16 *acc, qsizetype length);
+
+//dst[i] = acc[i] / 256 rounded - the weighted average once weights summing to 256 have been accumulated
+void resolve_accumulated(const quint16 *acc, uchar *dst, qsizetype length);
+
+/*
+ * Resample kernels (see Image_Resampler). Weights are fixed point with RESAMPLE_WEIGHT_BITS fraction bits, may be
+ * negative and sum to 1 << RESAMPLE_WEIGHT_BITS. Results are rounded and clamped to 0 to 255
+ */
+#define RESAMPLE_WEIGHT_BITS 14
+
+//dst[i] = sum over k of rows[k][i] * weights[k], for length bytes
+void resample_vertical(const uchar *const *rows, const qint16 *weights, int taps, uchar *dst, qsizetype length);
+
+//dst[x] = sum over k of src[offsets[x] + k] * weights[x * taps + k], each channel of dst_width pixels
+void resample_horizontal(const QRgb *src, QRgb *dst, qsizetype dst_width, const int *offsets, const qint16 *weights,
+                         int taps);
+
+#endif // SIMD_KERNELS_H
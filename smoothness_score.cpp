@@ -0,0 +1,122 @@
+#include <QtConcurrent>
+#include <QtMath>
+#include "smoothness_score.h"
+
+QJsonObject Smoothness_Report::to_json() const
+{
+    return QJsonObject{{"slot_count", slot_count}, {"mean_velocity", mean_velocity},
+                       {"max_acceleration", max_acceleration}, {"rms_acceleration", rms_acceleration},
+                       {"max_jerk", max_jerk}, {"rms_jerk", rms_jerk},
+                       {"longest_duplicate_run", longest_duplicate_run}, {"duplicate_slots", duplicate_slots},
+                       {"largest_skip", largest_skip}, {"largest_skip_slot", largest_skip_slot},
+                       {"max_motion_discontinuity", max_motion_discontinuity},
+                       {"rms_motion_discontinuity", rms_motion_discontinuity}, {"score", score}};
+}
+
+/*
+ * Score content_map. motion_energy, if given, has an entry per original frame - its difference from the frame before -
+ * and the motion shown by a slot is the sum over the frames passed over since the slot before.
+ */
+Smoothness_Report Smoothness_Scorer::score(const QVector<int> &content_map, const QVector<qreal> &motion_energy)
+{
+    Smoothness_Report report;
+    int length = content_map.length();
+    report.slot_count = length;
+    if (length == 0)
+        return report;
+
+    //Motion passed over up to each original frame
+    QVector<qreal>motion_before(motion_energy.length() + 1, 0.0);
+    for (int i=0; i < motion_energy.length(); i++)
+        motion_before[i+1] = motion_before.at(i) + (i > 0 ? motion_energy.at(i) : 0.0);
+
+    qreal sum_acceleration = 0.0;
+    qreal sum_jerk = 0.0;
+    qreal sum_motion = 0.0;
+    qreal sum_discontinuity = 0.0;
+    int velocity = 0, previous_velocity = 0, previous_acceleration = 0;
+    qreal motion = 0.0, previous_motion = 0.0;
+    int run = 1;
+    report.longest_duplicate_run = 1;
+
+    for (int i=1; i < length; i++){
+        velocity = content_map.at(i) - content_map.at(i-1);
+        if (velocity == 0){
+            report.duplicate_slots++;
+            run++;
+            report.longest_duplicate_run = qMax(report.longest_duplicate_run, run);
+        } else
+            run = 1;
+        if (qAbs(velocity) > report.largest_skip){
+            report.largest_skip = qAbs(velocity);
+            report.largest_skip_slot = i;
+        }
+
+        if (i >= 2){
+            int acceleration = velocity - previous_velocity;
+            report.max_acceleration = qMax(report.max_acceleration, (qreal)qAbs(acceleration));
+            sum_acceleration += acceleration * acceleration;
+            if (i >= 3){
+                int jerk = acceleration - previous_acceleration;
+                report.max_jerk = qMax(report.max_jerk, (qreal)qAbs(jerk));
+                sum_jerk += jerk * jerk;
+            }
+            previous_acceleration = acceleration;
+        }
+        previous_velocity = velocity;
+
+        if (!motion_energy.isEmpty()){
+            int from = qBound(0, qMin(content_map.at(i-1), content_map.at(i)), motion_energy.length() - 1);
+            int to = qBound(0, qMax(content_map.at(i-1), content_map.at(i)), motion_energy.length() - 1);
+            motion = motion_before.at(to + 1) - motion_before.at(from + 1);
+            sum_motion += motion;
+            if (i >= 2){
+                qreal change = qAbs(motion - previous_motion);
+                report.max_motion_discontinuity = qMax(report.max_motion_discontinuity, change);
+                sum_discontinuity += change * change;
+            }
+            previous_motion = motion;
+        }
+    }
+
+    report.mean_velocity = (qreal)(content_map.last() - content_map.first()) / qMax(1, length - 1);
+    report.rms_acceleration = qSqrt(sum_acceleration / qMax(1, length - 2));
+    report.rms_jerk = qSqrt(sum_jerk / qMax(1, length - 3));
+
+    //Relative to the mean motion shown per slot, so sequences with more or less motion compare
+    qreal mean_motion = sum_motion / qMax(1, length - 1);
+    if (mean_motion > 0.0){
+        report.max_motion_discontinuity /= mean_motion;
+        report.rms_motion_discontinuity = qSqrt(sum_discontinuity / qMax(1, length - 2)) / mean_motion;
+    } else
+        report.max_motion_discontinuity = 0.0;
+
+    report.score = SMOOTHNESS_JERK_WEIGHT * report.rms_jerk
+                 + SMOOTHNESS_DUPLICATE_WEIGHT * (report.longest_duplicate_run - 1)
+                 + SMOOTHNESS_DISCONTINUITY_WEIGHT * report.rms_motion_discontinuity;
+    return report;
+}
+
+struct Score_Job
+{
+    const QVector<int> *content_map;
+    Smoothness_Report report;
+};
+
+//Score every content map on all cores. The reports are in the order of content_maps
+QVector<Smoothness_Report> Smoothness_Scorer::score_all(const QVector<QVector<int>> &content_maps,
+                                                        const QVector<qreal> &motion_energy)
+{
+    QVector<Score_Job>jobs(content_maps.length());
+    for (int i=0; i < content_maps.length(); i++)
+        jobs[i].content_map = &content_maps.at(i);
+
+    QtConcurrent::blockingMap(jobs, [&motion_energy](Score_Job &job) {
+        job.report = score(*job.content_map, motion_energy);
+    });
+
+    QVector<Smoothness_Report>reports;
+    for (int i=0; i < jobs.length(); i++)
+        reports.append(jobs.at(i).report);
+    return reports;
+}
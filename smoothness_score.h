@@ -0,0 +1,60 @@
+#ifndef SMOOTHNESS_SCORE_H
+#define SMOOTHNESS_SCORE_H
+
+#include <QtGlobal>
+#include <QJsonObject>
+#include <QVector>
+
+/*
+ * Weights of the metrics summed into Smoothness_Report::score
+ *   SMOOTHNESS_JERK_WEIGHT          - per unit of rms_jerk
+ *   SMOOTHNESS_DUPLICATE_WEIGHT     - per slot a frame is held beyond the first (longest_duplicate_run - 1)
+ *   SMOOTHNESS_DISCONTINUITY_WEIGHT - per unit of rms_motion_discontinuity
+ */
+#define SMOOTHNESS_JERK_WEIGHT 1.0
+#define SMOOTHNESS_DUPLICATE_WEIGHT 0.25
+#define SMOOTHNESS_DISCONTINUITY_WEIGHT 1.0
+
+/*
+ * Smoothness_Report holds the metrics of one retimed sequence. Progress is the original frame shown at each slot
+ * (content map), so velocity is in frames per slot and acceleration and jerk are its 1st and 2nd differences.
+ *   longest_duplicate_run     - most consecutive slots showing the same frame
+ *   duplicate_slots           - slots showing the same frame as the slot before
+ *   largest_skip              - largest jump in frames between consecutive slots, at largest_skip_slot
+ *   *_motion_discontinuity    - change in the motion shown (motion energy of the frames passed over) from one slot to
+ *                               the next, relative to the mean motion shown per slot. 0 without motion energy
+ *   score                     - weighted sum of the above, lower is smoother
+ */
+struct Smoothness_Report
+{
+    int slot_count = 0;
+    qreal mean_velocity = 0.0;
+    qreal max_acceleration = 0.0;
+    qreal rms_acceleration = 0.0;
+    qreal max_jerk = 0.0;
+    qreal rms_jerk = 0.0;
+    int longest_duplicate_run = 0;
+    int duplicate_slots = 0;
+    int largest_skip = 0;
+    int largest_skip_slot = -1;
+    qreal max_motion_discontinuity = 0.0;
+    qreal rms_motion_discontinuity = 0.0;
+    qreal score = 0.0;
+
+    QJsonObject to_json() const;
+};
+
+/*
+ * Smoothness_Scorer gives an objective measure of how smooth a retiming plays, from its content map and (optionally)
+ * the motion energy of the original frames (see Motion_Analysis::motion_energy). Scoring one content map is a single
+ * pass over it; score_all scores many, eg every curve of a sweep or the deploy history, on all cores.
+ */
+class Smoothness_Scorer
+{
+public:
+    static Smoothness_Report score(const QVector<int> &content_map, const QVector<qreal> &motion_energy = QVector<qreal>());
+    static QVector<Smoothness_Report> score_all(const QVector<QVector<int>> &content_maps,
+                                                const QVector<qreal> &motion_energy = QVector<qreal>());
+};
+
+#endif // SMOOTHNESS_SCORE_H
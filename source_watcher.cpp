@@ -0,0 +1,109 @@
+#include <QFileInfo>
+#include <QSet>
+#include "source_watcher.h"
+#include "frame.h"
+
+bool Source_Stamp::operator==(const Source_Stamp &other) const
+{
+    return exists == other.exists && size == other.size && modified == other.modified;
+}
+
+Source_Watcher::Source_Watcher(QObject *parent)
+    : QObject{parent}
+{
+    frame_count = 0;
+    watcher = new QFileSystemWatcher(this);
+    settle_timer = new QTimer(this);
+    settle_timer->setSingleShot(true);
+    settle_timer->setInterval(SOURCE_WATCH_SETTLE_MSECS);
+    connect(watcher, SIGNAL(directoryChanged(QString)), this, SLOT(path_changed()));
+    connect(watcher, SIGNAL(fileChanged(QString)), this, SLOT(path_changed()));
+    connect(settle_timer, SIGNAL(timeout()), this, SLOT(scan()));
+}
+
+/*
+ * Start watching the frame_count frames in directory. The files as they are now are the baseline - only later changes
+ * are reported. Returns false if the directory cannot be watched
+ */
+bool Source_Watcher::start(const QString &directory, int frame_count)
+{
+    stop();
+    this->directory = directory;
+    this->frame_count = frame_count;
+
+    stamps.clear();
+    for (int i=0; i < frame_count; i++)
+        stamps.append(stamp(i));
+
+    if (!watcher->addPath(directory))
+        return false;
+    watch_files();
+    return true;
+}
+
+void Source_Watcher::stop()
+{
+    settle_timer->stop();
+    if (!watcher->files().isEmpty())
+        watcher->removePaths(watcher->files());
+    if (!watcher->directories().isEmpty())
+        watcher->removePaths(watcher->directories());
+    stamps.clear();
+}
+
+bool Source_Watcher::is_watching() const
+{
+    return !watcher->directories().isEmpty();
+}
+
+//Stamp of the index-th frame's file as it is now
+Source_Stamp Source_Watcher::stamp(int index) const
+{
+    QFileInfo info(Frame::frame_filename(directory, index));
+    Source_Stamp stamp;
+    stamp.exists = info.exists();
+    stamp.size = stamp.exists ? info.size() : 0;
+    if (stamp.exists)
+        stamp.modified = info.lastModified();
+    return stamp;
+}
+
+//Watch every frame file which exists and is not watched already, eg one replaced or added since the last scan
+void Source_Watcher::watch_files()
+{
+    QSet<QString>watched;
+    for (const QString &file : watcher->files())
+        watched.insert(file);
+
+    QStringList files;
+    for (int i=0; i < frame_count; i++){
+        QString filename = Frame::frame_filename(directory, i);
+        if (stamps.at(i).exists && !watched.contains(filename))
+            files.append(filename);
+    }
+    if (!files.isEmpty())
+        watcher->addPaths(files);
+}
+
+//Something in the directory changed. Wait for it to settle before comparing, see SOURCE_WATCH_SETTLE_MSECS
+void Source_Watcher::path_changed()
+{
+    settle_timer->start();
+}
+
+//Compare the stamp of every frame with the last one seen and report the frames which changed
+void Source_Watcher::scan()
+{
+    QVector<int>changed;
+    for (int i=0; i < stamps.length(); i++){
+        Source_Stamp current = stamp(i);
+        if (current != stamps.at(i)){
+            stamps[i] = current;
+            changed.append(i);
+        }
+    }
+
+    watch_files();
+    if (!changed.isEmpty())
+        emit frames_changed(changed);
+}
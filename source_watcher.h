@@ -0,0 +1,67 @@
+#ifndef SOURCE_WATCHER_H
+#define SOURCE_WATCHER_H
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+
+/*
+ * SOURCE_WATCH_SETTLE_MSECS - changes are looked at only once the directory has been quiet for this long, so that a
+ *                             file written in several steps (or a batch of files exported at once) is read once, whole
+ */
+#define SOURCE_WATCH_SETTLE_MSECS 300
+
+/*
+ * Source_Stamp identifies the version of one .png of the sequence - it is taken to have changed when any of these do
+ */
+struct Source_Stamp
+{
+    bool exists;
+    qint64 size;
+    QDateTime modified;
+
+    bool operator==(const Source_Stamp &other) const;
+    bool operator!=(const Source_Stamp &other) const { return !(*this == other); }
+};
+
+/*
+ * Source_Watcher watches the directory of an animated sequence (see Frame::frame_filename) for .png files being
+ * changed, added or removed, and emits frames_changed() with the index of each frame which did. Only the frame_count
+ * files of the sequence are compared, by their Source_Stamp, so nothing is read or decoded to find what changed.
+ *
+ * Editors often save by writing a new file and renaming it over the old one, which drops the old file from a
+ * QFileSystemWatcher. The directory is watched too and the files are watched again after every change.
+ */
+class Source_Watcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit Source_Watcher(QObject *parent = nullptr);
+
+    QString directory;
+    int frame_count;
+
+    bool start(const QString &directory, int frame_count);
+    void stop();
+    bool is_watching() const;
+
+signals:
+    void frames_changed(const QVector<int> &indexes);
+
+private slots:
+    void path_changed();
+    void scan();
+
+private:
+    QFileSystemWatcher *watcher;
+    QTimer *settle_timer;
+    QVector<Source_Stamp>stamps;
+
+    Source_Stamp stamp(int index) const;
+    void watch_files();
+};
+
+#endif // SOURCE_WATCHER_H
@@ -0,0 +1,150 @@
+#include <QtConcurrent>
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include "sprite_atlas.h"
+#include "image_resampler.h"
+
+/*
+ * Find the distinct frames of slot_images and pack them into pages, shelf by shelf - frames are placed left to right
+ * along a shelf as tall as its tallest frame, and a new shelf (or page) is started when one is full. Frames of a
+ * sequence are mostly one size, so the shelves pack as a grid. No pixels are copied until save(), except to reduce a
+ * frame larger than a page.
+ */
+void Sprite_Atlas::build(const QVector<QImage> &slot_images)
+{
+    frame_images.clear();
+    frames.clear();
+    page_sizes.clear();
+    slot_frames.clear();
+
+    //Slots showing the same image (shared pixels) are one frame
+    QHash<qint64, int>frame_of_image;
+    for (int i=0; i < slot_images.length(); i++){
+        qint64 key = slot_images.at(i).cacheKey();
+        if (!frame_of_image.contains(key)){
+            frame_of_image.insert(key, frame_images.length());
+            frame_images.append(slot_images.at(i));
+        }
+        slot_frames.append(frame_of_image.value(key));
+    }
+
+    int x = 0, y = 0, shelf_height = 0;
+    QSize page_size;
+    for (int i=0; i < frame_images.length(); i++){
+        QSize size = frame_images.at(i).size();
+        qreal scale = 1.0;
+        if (size.width() > SPRITE_ATLAS_MAX_PAGE_SIZE || size.height() > SPRITE_ATLAS_MAX_PAGE_SIZE){
+            scale = (qreal)SPRITE_ATLAS_MAX_PAGE_SIZE / qMax(size.width(), size.height());
+            size = size.scaled(SPRITE_ATLAS_MAX_PAGE_SIZE, SPRITE_ATLAS_MAX_PAGE_SIZE, Qt::KeepAspectRatio)
+                       .expandedTo(QSize(1, 1));
+            frame_images[i] = Image_Resampler::resample(frame_images.at(i), size, RESAMPLE_BEST);
+        }
+        if (x > 0 && x + size.width() > SPRITE_ATLAS_MAX_PAGE_SIZE){
+            x = 0;
+            y += shelf_height + SPRITE_ATLAS_PADDING;
+            shelf_height = 0;
+        }
+        if (page_sizes.isEmpty() || (y > 0 && y + size.height() > SPRITE_ATLAS_MAX_PAGE_SIZE)){
+            page_sizes.append(QSize(0, 0));
+            x = 0;
+            y = 0;
+            shelf_height = 0;
+        }
+
+        frames.append({page_sizes.length() - 1, QRect(QPoint(x, y), size), scale});
+        page_sizes.last() = page_sizes.last().expandedTo(QSize(x + size.width(), y + size.height()));
+        x += size.width() + SPRITE_ATLAS_PADDING;
+        shelf_height = qMax(shelf_height, size.height());
+    }
+}
+
+struct Atlas_Page_Job
+{
+    int page;
+    QString filename;
+    bool saved;
+};
+
+//Write the pages, the JSON frame table and the binary frame table. See Sprite_Atlas
+bool Sprite_Atlas::save(const QString &base, int fps) const
+{
+    QVector<Atlas_Page_Job>jobs;
+    for (int i=0; i < page_sizes.length(); i++)
+        jobs.append({i, QString("%1_%2.png").arg(base).arg(i), false});
+
+    //Each page is drawn and encoded on its own core - PNG encoding is by far the slowest part
+    QtConcurrent::blockingMap(jobs, [this](Atlas_Page_Job &job) {
+        QImage page(page_sizes.at(job.page), QImage::Format_ARGB32_Premultiplied);
+        page.fill(Qt::transparent);
+        QPainter painter(&page);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        for (int i=0; i < frames.length(); i++){
+            if (frames.at(i).page == job.page)
+                painter.drawImage(frames.at(i).rect.topLeft(), frame_images.at(i), QRect(QPoint(0, 0), frames.at(i).rect.size()));
+        }
+        painter.end();
+        job.saved = page.save(job.filename, "PNG");
+    });
+
+    for (int i=0; i < jobs.length(); i++){
+        if (!jobs.at(i).saved)
+            return false;
+    }
+    return save_table(base, fps) && save_binary_table(base, fps);
+}
+
+bool Sprite_Atlas::save_table(const QString &base, int fps) const
+{
+    QJsonArray pages_array;
+    for (int i=0; i < page_sizes.length(); i++)
+        pages_array.append(QJsonObject{{"file", QFileInfo(QString("%1_%2.png").arg(base).arg(i)).fileName()},
+                                       {"width", page_sizes.at(i).width()}, {"height", page_sizes.at(i).height()}});
+
+    //Each frame as an array rather than an object, so the table stays compact for long sequences
+    QJsonArray frames_array;
+    for (int i=0; i < frames.length(); i++){
+        const QRect &rect = frames.at(i).rect;
+        frames_array.append(QJsonArray{frames.at(i).page, rect.x(), rect.y(), rect.width(), rect.height(),
+                                       frames.at(i).scale});
+    }
+
+    QJsonArray slots_array;
+    for (int i=0; i < slot_frames.length(); i++)
+        slots_array.append(slot_frames.at(i));
+
+    QFile file(base + ".json");
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    QJsonObject root_object{{"fps", fps}, {"pages", pages_array}, {"frames", frames_array}, {"slots", slots_array}};
+    return file.write(QJsonDocument(root_object).toJson(QJsonDocument::Compact)) > 0;
+}
+
+bool Sprite_Atlas::save_binary_table(const QString &base, int fps) const
+{
+    QFile file(base + ".atlas");
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    stream.writeRawData(SPRITE_ATLAS_MAGIC, 4);
+    stream << (quint16)SPRITE_ATLAS_VERSION << (quint16)fps;
+    stream << (quint32)page_sizes.length() << (quint32)frames.length() << (quint32)slot_frames.length();
+    for (int i=0; i < page_sizes.length(); i++)
+        stream << (quint16)page_sizes.at(i).width() << (quint16)page_sizes.at(i).height();
+    for (int i=0; i < frames.length(); i++){
+        const QRect &rect = frames.at(i).rect;
+        stream << (quint16)frames.at(i).page << (quint16)rect.x() << (quint16)rect.y()
+               << (quint16)rect.width() << (quint16)rect.height() << (float)frames.at(i).scale;
+    }
+    for (int i=0; i < slot_frames.length(); i++)
+        stream << (quint32)slot_frames.at(i);
+    return stream.status() == QDataStream::Ok;
+}
@@ -0,0 +1,63 @@
+#ifndef SPRITE_ATLAS_H
+#define SPRITE_ATLAS_H
+
+#include <QtGlobal>
+#include <QImage>
+#include <QRect>
+#include <QString>
+#include <QVector>
+
+/*
+ * SPRITE_ATLAS_MAX_PAGE_SIZE - largest width and height of an atlas page, the texture size most GPUs support
+ * SPRITE_ATLAS_PADDING       - transparent pixels between frames, so that filtering does not bleed between them
+ * SPRITE_ATLAS_MAGIC         - first 4 bytes of the binary frame table
+ * SPRITE_ATLAS_VERSION       - version of the binary frame table
+ */
+#define SPRITE_ATLAS_MAX_PAGE_SIZE 4096
+#define SPRITE_ATLAS_PADDING 2
+#define SPRITE_ATLAS_MAGIC "ATLS"
+#define SPRITE_ATLAS_VERSION 2
+
+/*
+ * Where a frame is in the atlas - its page and its rectangle on the page. scale is the size of the frame on the page
+ * over its size in the sequence - 1.0 unless the frame was larger than a page and was reduced to fit
+ */
+struct Atlas_Frame
+{
+    int page;
+    QRect rect;
+    qreal scale;
+};
+
+/*
+ * Sprite_Atlas packs the frames of a retimed sequence into as few atlas pages (textures) as possible, each distinct
+ * frame once - slots which show the same image (eg frames extended by the retiming) share one frame. The frame table
+ * maps each slot to its frame and each frame to its rectangle, so playback is a lookup of the slot and a draw of one
+ * rectangle of one texture. A frame larger than SPRITE_ATLAS_MAX_PAGE_SIZE is reduced to fit a page (see
+ * Image_Resampler), and its scale is kept in the table so that it can be drawn back at its size.
+ *
+ * save(base) writes
+ *   <base>_<page>.png - the pages, encoded in parallel
+ *   <base>.json       - {"fps", "pages": [{"file", "width", "height"}], "frames": [[page, x, y, width, height, scale]],
+ *                        "slots": [frame of each slot]}
+ *   <base>.atlas      - the same table in binary, little endian: SPRITE_ATLAS_MAGIC, quint16 version, quint16 fps,
+ *                       quint32 page/frame/slot counts, then quint16 width, height per page, quint16 page, x, y,
+ *                       width, height and float scale per frame and quint32 frame per slot
+ */
+class Sprite_Atlas
+{
+public:
+    QVector<QImage>frame_images;
+    QVector<Atlas_Frame>frames;
+    QVector<QSize>page_sizes;
+    QVector<int>slot_frames;
+
+    void build(const QVector<QImage> &slot_images);
+    bool save(const QString &base, int fps) const;
+
+private:
+    bool save_table(const QString &base, int fps) const;
+    bool save_binary_table(const QString &base, int fps) const;
+};
+
+#endif // SPRITE_ATLAS_H
@@ -0,0 +1,102 @@
+#include "stream_writer.h"
+#include "simd_kernels.h"
+
+Stream_Writer::Stream_Writer(QIODevice *device, Stream_Format format, int fps)
+{
+    this->device = device;
+    this->format = format;
+    this->fps = qMax(1, fps);
+    this->frames_written = 0;
+}
+
+//"y4m" or "rgba"
+bool Stream_Writer::parse_format(const QString &name, Stream_Format *format)
+{
+    QString key = name.trimmed().toLower();
+    if (key == "y4m" || key == "yuv4mpeg2")
+        *format = STREAM_Y4M;
+    else if (key == "rgba" || key == "raw")
+        *format = STREAM_RGBA;
+    else
+        return false;
+    return true;
+}
+
+//The stream header, written before the first frame. Raw RGBA has none
+bool Stream_Writer::write_header()
+{
+    if (format != STREAM_Y4M)
+        return true;
+
+    QByteArray header = QString("YUV4MPEG2 W%1 H%2 F%3:1 Ip A1:1 C420jpeg\n").arg(size.width()).arg(size.height())
+            .arg(fps).toLatin1();
+    return device->write(header) == header.size();
+}
+
+/*
+ * Write the next frame. The size of the first frame sets the size of the stream; a frame of another size is rejected.
+ * Returns false on a write error (eg the reading end of the pipe closed)
+ */
+bool Stream_Writer::write_frame(const QImage &image)
+{
+    if (image.isNull())
+        return false;
+
+    if (frames_written == 0){
+        size = image.size();
+        if (!write_header())
+            return false;
+    } else if (image.size() != size)
+        return false;
+
+    bool ok;
+    if (format == STREAM_Y4M)
+        ok = write_y4m_frame(image);
+    else
+        ok = write_rgba_frame(image);
+
+    if (ok)
+        frames_written++;
+    return ok;
+}
+
+//"FRAME" then the Y, U and V planes. U and V are (width+1)/2 x (height+1)/2
+bool Stream_Writer::write_y4m_frame(const QImage &image)
+{
+    QImage rgb = image.convertToFormat(QImage::Format_RGB32);
+    int width = size.width();
+    int height = size.height();
+    int chroma_width = (width + 1) / 2;
+    int chroma_height = (height + 1) / 2;
+
+    //One buffer holding the 3 planes, reused for every frame
+    qsizetype luma_bytes = (qsizetype)width * height;
+    qsizetype chroma_bytes = (qsizetype)chroma_width * chroma_height;
+    frame_buffer.resize(luma_bytes + 2 * chroma_bytes);
+    uchar *y_plane = (uchar *)frame_buffer.data();
+    uchar *u_plane = y_plane + luma_bytes;
+    uchar *v_plane = u_plane + chroma_bytes;
+
+    for (int y=0; y < height; y++)
+        rgb_to_luma((const QRgb *)rgb.constScanLine(y), y_plane + (qsizetype)y * width, width);
+    for (int y=0; y < chroma_height; y++){
+        const QRgb *row0 = (const QRgb *)rgb.constScanLine(2*y);
+        const QRgb *row1 = (const QRgb *)rgb.constScanLine(qMin(2*y + 1, height - 1));
+        rgb_to_chroma_420(row0, row1, u_plane + (qsizetype)y * chroma_width, v_plane + (qsizetype)y * chroma_width, width);
+    }
+
+    static const QByteArray frame_header("FRAME\n");
+    return device->write(frame_header) == frame_header.size() && device->write(frame_buffer) == frame_buffer.size();
+}
+
+//Scanlines of RGBA without any padding
+bool Stream_Writer::write_rgba_frame(const QImage &image)
+{
+    QImage rgba = image.convertToFormat(QImage::Format_RGBA8888);
+    qint64 line_bytes = (qint64)size.width() * 4;
+    for (int y=0; y < size.height(); y++){
+        if (device->write((const char *)rgba.constScanLine(y), line_bytes) != line_bytes)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,45 @@
+#ifndef STREAM_WRITER_H
+#define STREAM_WRITER_H
+
+#include <QtGlobal>
+#include <QIODevice>
+#include <QImage>
+#include <QVector>
+#include <QByteArray>
+
+/*
+ * Stream_Format
+ *   STREAM_Y4M  - YUV4MPEG2, 4:2:0 full range BT.601 (C420jpeg), readable by most encoders (eg "-f yuv4mpegpipe")
+ *   STREAM_RGBA - raw 8 bit RGBA frames one after the other without any header (eg "-f rawvideo -pix_fmt rgba")
+ */
+enum Stream_Format {
+    STREAM_Y4M = 0,
+    STREAM_RGBA
+};
+
+/*
+ * Stream_Writer writes frames in order to a device (a file, stdout or a pipe) as they are rendered, so the retimed
+ * timeline can be piped straight into an encoder without any intermediate files. All frames must have the size of
+ * the first. The RGB to YUV conversion uses the vectorized rgb_to_luma/rgb_to_chroma_420 kernels.
+ */
+class Stream_Writer
+{
+public:
+    Stream_Writer(QIODevice *device, Stream_Format format, int fps);
+    QIODevice *device;
+    Stream_Format format;
+    int fps;
+    QSize size;
+    qint64 frames_written;
+
+    bool write_frame(const QImage &image);
+    static bool parse_format(const QString &name, Stream_Format *format);
+
+private:
+    QByteArray frame_buffer;
+    bool write_header();
+    bool write_y4m_frame(const QImage &image);
+    bool write_rgba_frame(const QImage &image);
+};
+
+#endif // STREAM_WRITER_H
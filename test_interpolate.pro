@@ -1,4 +1,4 @@
-QT       += core gui
+QT       += core gui concurrent network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -10,14 +10,76 @@ CONFIG += c++17
 
 SOURCES += \
     bezier_curve.cpp \
+    curve_extraction.cpp \
+    curve_sweep.cpp \
+    deploy_worker.cpp \
+    easing_policy.cpp \
+    easing_table.cpp \
+    filmstrip.cpp \
+    fixed_point_retimer.cpp \
     frame.cpp \
+    frame_arena.cpp \
+    image_resampler.cpp \
+    keyframe_timeline.cpp \
+    loop_analysis.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    memory_accounting.cpp \
+    motion_analysis.cpp \
+    motion_blur.cpp \
+    palette_storage.cpp \
+    playback_hud.cpp \
+    playback_telemetry.cpp \
+    playlist.cpp \
+    playlist_player.cpp \
+    retime_cache.cpp \
+    retime_daemon.cpp \
+    sequence_loader.cpp \
+    simd_kernels.cpp \
+    smoothness_score.cpp \
+    source_watcher.cpp \
+    sprite_atlas.cpp \
+    stream_writer.cpp \
+    tile_grid.cpp \
+    timeline_history.cpp \
+    variant_grid.cpp
 
 HEADERS += \
     bezier_curve.h \
+    bezier_points.h \
+    curve_extraction.h \
+    curve_sweep.h \
+    deploy_worker.h \
+    easing_policy.h \
+    easing_table.h \
+    filmstrip.h \
+    fixed_point_retimer.h \
     frame.h \
-    mainwindow.h
+    frame_arena.h \
+    image_resampler.h \
+    keyframe_timeline.h \
+    loop_analysis.h \
+    mainwindow.h \
+    memory_accounting.h \
+    motion_analysis.h \
+    motion_blur.h \
+    palette_storage.h \
+    playback_hud.h \
+    playback_telemetry.h \
+    playlist.h \
+    playlist_player.h \
+    retime_cache.h \
+    retime_daemon.h \
+    retime_timeline.h \
+    sequence_loader.h \
+    simd_kernels.h \
+    smoothness_score.h \
+    source_watcher.h \
+    sprite_atlas.h \
+    stream_writer.h \
+    tile_grid.h \
+    timeline_history.h \
+    variant_grid.h
 
 FORMS += \
     mainwindow.ui
@@ -0,0 +1,111 @@
+#include <QtTest>
+#include "bezier_curve.h"
+#include "fixed_point_retimer.h"
+
+/*
+ * FIXED_POINT_DEGREE_TOLERANCE - largest difference in degrees allowed between the fixed point and floating point
+ *                                degrees lists. Q16.16 resolves 1/65536 of a degree, the paths differ by ~0.00001
+ */
+#define FIXED_POINT_DEGREE_TOLERANCE 0.001
+
+Q_DECLARE_METATYPE(Bezier_Points)
+
+/*
+ * Test_Fixed_Point checks Bezier_Curve::compute_bezier_degrees_fixed (Fixed_Point_Retimer) against the floating
+ * point Bezier_Curve::compute_bezier_degrees, and Fixed_Point_Retimer::atan_degrees against known values
+ */
+class Test_Fixed_Point : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void atan_degrees_data();
+    void atan_degrees();
+    void compare_paths_data();
+    void compare_paths();
+};
+
+void Test_Fixed_Point::atan_degrees_data()
+{
+    QTest::addColumn<qint64>("dy");
+    QTest::addColumn<qint64>("dx");
+    QTest::addColumn<int>("expected");
+
+    //Expected values are Q16.16 degrees - ie round(atan(dy/dx) in degrees * 65536)
+    QTest::newRow("45") << Q_INT64_C(1) << Q_INT64_C(1) << 2949120;
+    QTest::newRow("-45") << Q_INT64_C(-1) << Q_INT64_C(1) << -2949120;
+    QTest::newRow("-45 negative dx") << Q_INT64_C(1) << Q_INT64_C(-1) << -2949120;
+    QTest::newRow("45 negative dx dy") << Q_INT64_C(-1) << Q_INT64_C(-1) << 2949120;
+    QTest::newRow("horizontal") << Q_INT64_C(0) << Q_INT64_C(1) << 0;
+    QTest::newRow("vertical") << Q_INT64_C(1) << Q_INT64_C(0) << 0;
+    QTest::newRow("1/2") << Q_INT64_C(1) << Q_INT64_C(2) << 1740967;
+    QTest::newRow("3/4") << Q_INT64_C(3) << Q_INT64_C(4) << 2416306;
+    QTest::newRow("default linear line") << Q_INT64_C(-73) << Q_INT64_C(1847) << -148331;
+    QTest::newRow("near vertical") << Q_INT64_C(1000000) << Q_INT64_C(1) << 5898236;
+    QTest::newRow("near horizontal") << Q_INT64_C(1) << Q_INT64_C(1000000) << 4;
+    QTest::newRow("large") << Q_INT64_C(12345678901) << Q_INT64_C(98765432109) << 466945;
+}
+
+void Test_Fixed_Point::atan_degrees()
+{
+    QFETCH(qint64, dy);
+    QFETCH(qint64, dx);
+    QFETCH(int, expected);
+
+    QCOMPARE(Fixed_Point_Retimer::atan_degrees(dy, dx), expected);
+}
+
+void Test_Fixed_Point::compare_paths_data()
+{
+    QTest::addColumn<Bezier_Points>("points");
+    QTest::addColumn<int>("frame_count");
+
+    //Same points as Bezier_Curve - the linear line it starts with, and the Ease-In and S-shaped curves
+    Bezier_Points linear = {QPoint(37,110), QPoint(37,110), QPoint(1884,37), QPoint(1884,37)};
+    Bezier_Points ease_in = Bezier_Curve::selected_bezier_points();
+    Bezier_Points ease_in_ease_out = {QPoint(37,110), QPoint(117,4), QPoint(1775,162), QPoint(1884,37)};
+
+    const int frame_counts[] = {1, 25, 60, 100, 101, 240};
+    for (int frame_count : frame_counts){
+        QTest::addRow("linear %d", frame_count) << linear << frame_count;
+        QTest::addRow("ease-in %d", frame_count) << ease_in << frame_count;
+        QTest::addRow("ease-in ease-out %d", frame_count) << ease_in_ease_out << frame_count;
+    }
+}
+
+void Test_Fixed_Point::compare_paths()
+{
+    QFETCH(Bezier_Points, points);
+    QFETCH(int, frame_count);
+
+    //The begin angle is taken from the linear line between the 2 end points, as Bezier_Curve does
+    Bezier_Points linear = {points.p0, points.p0, points.p1, points.p1};
+    qreal begin_angle = 0.0;
+    qreal fixed_begin_angle = 0.0;
+    QList<qreal>degrees_list;
+    QList<float>skip_list;
+    QList<qreal>fixed_degrees_list;
+    QList<float>fixed_skip_list;
+    Bezier_Curve::compute_bezier_degrees(linear, true, frame_count, &begin_angle, &degrees_list, &skip_list);
+    Bezier_Curve::compute_bezier_degrees_fixed(linear, true, frame_count, &fixed_begin_angle, &fixed_degrees_list,
+                                               &fixed_skip_list);
+    QVERIFY(qAbs(fixed_begin_angle - begin_angle) <= FIXED_POINT_DEGREE_TOLERANCE);
+
+    Bezier_Curve::compute_bezier_degrees(points, false, frame_count, &begin_angle, &degrees_list, &skip_list);
+    Bezier_Curve::compute_bezier_degrees_fixed(points, false, frame_count, &fixed_begin_angle, &fixed_degrees_list,
+                                               &fixed_skip_list);
+
+    QCOMPARE(fixed_degrees_list.length(), degrees_list.length());
+    for (int i=0; i < degrees_list.length(); i++){
+        if (qAbs(fixed_degrees_list.at(i) - degrees_list.at(i)) > FIXED_POINT_DEGREE_TOLERANCE)
+            QFAIL(qPrintable(QString("Degree %1 fixed=%2 float=%3").arg(i).arg(fixed_degrees_list.at(i))
+                             .arg(degrees_list.at(i))));
+    }
+
+    QCOMPARE(fixed_skip_list.length(), frame_count);
+    QCOMPARE(fixed_skip_list, skip_list);
+}
+
+QTEST_MAIN(Test_Fixed_Point)
+
+#include "test_fixed_point.moc"
@@ -0,0 +1,29 @@
+QT       += core gui concurrent testlib
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+CONFIG += c++17 testcase
+
+TARGET = test_fixed_point
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    test_fixed_point.cpp \
+    ../../bezier_curve.cpp \
+    ../../fixed_point_retimer.cpp \
+    ../../frame.cpp \
+    ../../frame_arena.cpp \
+    ../../image_resampler.cpp \
+    ../../memory_accounting.cpp \
+    ../../palette_storage.cpp \
+    ../../playback_telemetry.cpp \
+    ../../retime_cache.cpp \
+    ../../simd_kernels.cpp \
+    ../../tile_grid.cpp
+
+HEADERS += \
+    ../../bezier_curve.h \
+    ../../bezier_points.h \
+    ../../fixed_point_retimer.h \
+    ../../frame.h
@@ -0,0 +1,132 @@
+#include <cstring>
+#include <QtConcurrent>
+#include "tile_grid.h"
+#include "simd_kernels.h"
+
+//A tile and the result of the operation on it
+struct Tile_Job
+{
+    QRect rect;
+    qint64 result;
+};
+
+static QVector<Tile_Job> tile_jobs(const QSize &size)
+{
+    Tile_Grid grid(size);
+    QVector<Tile_Job>jobs;
+    for (int i=0; i < grid.tiles.length(); i++)
+        jobs.append({grid.tiles.at(i), 0});
+    return jobs;
+}
+
+Tile_Grid::Tile_Grid(const QSize &size, int tile_size)
+{
+    this->size = size;
+    this->tile_size = qMax(1, tile_size);
+    for (int y=0; y < size.height(); y += this->tile_size)
+        for (int x=0; x < size.width(); x += this->tile_size)
+            tiles.append(QRect(x, y, qMin(this->tile_size, size.width() - x), qMin(this->tile_size, size.height() - y)));
+}
+
+bool Tile_Grid::use_tiles(const QSize &size)
+{
+    return (qint64)size.width() * size.height() >= TILE_PARALLEL_MIN_PIXELS;
+}
+
+/*
+ * Same as the image_difference kernel (mean absolute difference per channel, -1 if the images differ in size, compared
+ * as ARGB32 if their formats differ), summed tile by tile in parallel
+ */
+qreal Tile_Grid::image_difference(const QImage &a, const QImage &b)
+{
+    if (a.format() != b.format() && a.size() == b.size() && !a.isNull()
+            && a.format() != QImage::Format_Indexed8 && b.format() != QImage::Format_Indexed8)
+        return image_difference(a.convertToFormat(QImage::Format_ARGB32), b.convertToFormat(QImage::Format_ARGB32));
+    if (a.size() != b.size() || a.format() != b.format() || a.isNull() || a.depth() % 8 != 0
+            || a.format() == QImage::Format_Indexed8)
+        return ::image_difference(a, b);
+
+    int bytes_per_pixel = a.depth() / 8;
+    QVector<Tile_Job>jobs = tile_jobs(a.size());
+    QtConcurrent::blockingMap(jobs, [&a, &b, bytes_per_pixel](Tile_Job &job) {
+        qsizetype offset = (qsizetype)job.rect.x() * bytes_per_pixel;
+        qsizetype length = (qsizetype)job.rect.width() * bytes_per_pixel;
+        for (int y=job.rect.top(); y <= job.rect.bottom(); y++)
+            job.result += sad_u8(a.constScanLine(y) + offset, b.constScanLine(y) + offset, length);
+    });
+
+    qint64 sad = 0;
+    for (int i=0; i < jobs.length(); i++)
+        sad += jobs.at(i).result;
+    qint64 bytes = (qint64)a.width() * a.height() * bytes_per_pixel;
+    return bytes == 0 ? 0.0 : (qreal)sad / bytes;
+}
+
+/*
+ * Copy the pixels of src into *dst tile by tile in parallel. Both must have the same size and format (eg *dst is a
+ * Frame_Arena image). Returns false otherwise.
+ */
+bool Tile_Grid::copy_into(const QImage &src, QImage *dst)
+{
+    if (src.size() != dst->size() || src.format() != dst->format() || src.depth() % 8 != 0)
+        return false;
+
+    int bytes_per_pixel = src.depth() / 8;
+    if (src.format() == QImage::Format_Indexed8)
+        dst->setColorTable(src.colorTable());
+
+    //Detach (if shared) once here rather than from every tile
+    uchar *dst_bits = dst->bits();
+    qsizetype dst_bytes_per_line = dst->bytesPerLine();
+
+    QVector<Tile_Job>jobs = tile_jobs(src.size());
+    QtConcurrent::blockingMap(jobs, [&src, dst_bits, dst_bytes_per_line, bytes_per_pixel](Tile_Job &job) {
+        qsizetype offset = (qsizetype)job.rect.x() * bytes_per_pixel;
+        qsizetype length = (qsizetype)job.rect.width() * bytes_per_pixel;
+        for (int y=job.rect.top(); y <= job.rect.bottom(); y++)
+            memcpy(dst_bits + y * dst_bytes_per_line + offset, src.constScanLine(y) + offset, length);
+    });
+    return true;
+}
+
+/*
+ * Weighted average of images (weights summing to 256, see accumulate_weighted), premultiplied ARGB32. Each tile has
+ * its own accumulator, so the working set is a tile of each image plus one tile accumulator per core.
+ * A null image if the images differ in size.
+ */
+QImage Tile_Grid::blend(const QVector<QImage> &images, const QVector<quint16> &weights)
+{
+    if (images.isEmpty() || images.length() != weights.length())
+        return QImage();
+
+    QImage::Format format = QImage::Format_ARGB32_Premultiplied;
+    QSize size = images.first().size();
+    QVector<QImage>converted;
+    for (int i=0; i < images.length(); i++){
+        if (images.at(i).size() != size)
+            return QImage();
+        converted.append(images.at(i).convertToFormat(format));
+    }
+
+    QImage blended(size, format);
+    uchar *blended_bits = blended.bits();
+    qsizetype blended_bytes_per_line = blended.bytesPerLine();
+
+    QVector<Tile_Job>jobs = tile_jobs(size);
+    QtConcurrent::blockingMap(jobs, [&converted, &weights, blended_bits, blended_bytes_per_line](Tile_Job &job) {
+        qsizetype offset = (qsizetype)job.rect.x() * 4;
+        qsizetype length = (qsizetype)job.rect.width() * 4;
+        QVector<quint16>accumulator(length * job.rect.height(), 0);
+
+        for (int i=0; i < converted.length(); i++){
+            for (int y=0; y < job.rect.height(); y++)
+                accumulate_weighted(converted.at(i).constScanLine(job.rect.top() + y) + offset, weights.at(i),
+                                    accumulator.data() + y * length, length);
+        }
+        for (int y=0; y < job.rect.height(); y++)
+            resolve_accumulated(accumulator.constData() + y * length,
+                                blended_bits + (job.rect.top() + y) * blended_bytes_per_line + offset, length);
+    });
+
+    return blended;
+}
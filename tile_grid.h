@@ -0,0 +1,39 @@
+#ifndef TILE_GRID_H
+#define TILE_GRID_H
+
+#include <QtGlobal>
+#include <QImage>
+#include <QRect>
+#include <QVector>
+
+/*
+ * TILE_SIZE                 - width and height in pixels of a tile (tiles on the right and bottom edges may be smaller)
+ * TILE_PARALLEL_MIN_PIXELS  - frames of at least this many pixels (1080p) are processed tile by tile in parallel. Smaller
+ *                             frames are cheaper processed whole, in parallel across frames
+ */
+#define TILE_SIZE 256
+#define TILE_PARALLEL_MIN_PIXELS (1920 * 1080)
+
+/*
+ * Tile_Grid splits a frame into TILE_SIZE x TILE_SIZE tiles. The per-frame operations below work tile by tile with
+ * the tiles spread across cores, so a 4K/8K frame is processed by every core and each core only touches one tile
+ * (a few hundred KB) of every image at a time rather than whole frames.
+ *
+ * They are called from the GUI thread or a Deploy_Worker. Code already parallel across frames on the global thread
+ * pool (eg Loop_Analysis) calls them one frame at a time instead, see use_tiles.
+ */
+class Tile_Grid
+{
+public:
+    explicit Tile_Grid(const QSize &size, int tile_size = TILE_SIZE);
+    QSize size;
+    int tile_size;
+    QVector<QRect>tiles;
+
+    static bool use_tiles(const QSize &size);
+    static qreal image_difference(const QImage &a, const QImage &b);
+    static bool copy_into(const QImage &src, QImage *dst);
+    static QImage blend(const QVector<QImage> &images, const QVector<quint16> &weights);
+};
+
+#endif // TILE_GRID_H
@@ -0,0 +1,145 @@
+#include "timeline_history.h"
+#include "memory_accounting.h"
+
+Timeline_History::Timeline_History()
+{
+    current_index = -1;
+}
+
+Timeline_History::~Timeline_History()
+{
+    clear();
+}
+
+/*
+ * Push a deploy, after the current snapshot. Any snapshots undone are dropped, as is the oldest beyond
+ * TIMELINE_HISTORY_DEPTH. images holds the image of each slot of timeline and source_images the original Frames'.
+ */
+void Timeline_History::push(const QString &name, const Retime_Timeline &timeline, const QVector<QImage> &images,
+                            const QVector<QImage> &source_images)
+{
+    while (snapshots.length() > current_index + 1)
+        drop(snapshots.length() - 1);
+
+    Timeline_Snapshot snapshot;
+    snapshot.name = name;
+    snapshot.timeline = timeline;
+    snapshot.accounted_bytes = 0;
+
+    //Share the arrays unchanged since the previous snapshot rather than holding a second copy
+    if (!snapshots.isEmpty()){
+        const Retime_Timeline &previous = snapshots.last().timeline;
+        if (previous.src_index == timeline.src_index)
+            snapshot.timeline.src_index = previous.src_index;
+        if (previous.content_index == timeline.content_index)
+            snapshot.timeline.content_index = previous.content_index;
+        if (previous.delta == timeline.delta)
+            snapshot.timeline.delta = previous.delta;
+        if (previous.overwritten == timeline.overwritten)
+            snapshot.timeline.overwritten = previous.overwritten;
+    }
+
+    keep_images(&snapshot, images, source_images);
+
+    snapshots.append(snapshot);
+    if (snapshots.length() > TIMELINE_HISTORY_DEPTH)
+        drop(0);
+    current_index = snapshots.length() - 1;
+}
+
+/*
+ * Replace the images of the current snapshot, eg once the original Frames blended into some of its slots have been
+ * reloaded. Earlier and later snapshots keep the images they were deployed with
+ */
+void Timeline_History::update_current(const QVector<QImage> &images, const QVector<QImage> &source_images)
+{
+    if (current_index < 0)
+        return;
+    Timeline_Snapshot &snapshot = snapshots[current_index];
+    Memory_Accounting::instance()->release(MEMORY_RETIMED_FRAMES, snapshot.accounted_bytes);
+    keep_images(&snapshot, images, source_images);
+}
+
+//Keep only the images of snapshot which are not the original Frame of their slot, and account them
+void Timeline_History::keep_images(Timeline_Snapshot *snapshot, const QVector<QImage> &images,
+                                   const QVector<QImage> &source_images)
+{
+    snapshot->images.clear();
+    snapshot->images.resize(images.length());
+    snapshot->accounted_bytes = 0;
+    for (int i=0; i < images.length(); i++){
+        int content_index = snapshot->timeline.content_index.value(i, -1);
+        if (content_index >= 0 && content_index < source_images.length()
+                && images.at(i).cacheKey() == source_images.at(content_index).cacheKey())
+            continue;
+        snapshot->images[i] = images.at(i);
+        snapshot->accounted_bytes += images.at(i).sizeInBytes();
+    }
+    Memory_Accounting::instance()->add(MEMORY_RETIMED_FRAMES, snapshot->accounted_bytes);
+}
+
+void Timeline_History::clear()
+{
+    while (!snapshots.isEmpty())
+        drop(snapshots.length() - 1);
+    current_index = -1;
+}
+
+//Remove the snapshot at index and release its images
+void Timeline_History::drop(int index)
+{
+    Memory_Accounting::instance()->release(MEMORY_RETIMED_FRAMES, snapshots.at(index).accounted_bytes);
+    snapshots.remove(index);
+}
+
+bool Timeline_History::can_undo() const
+{
+    return current_index > 0;
+}
+
+bool Timeline_History::can_redo() const
+{
+    return current_index + 1 < snapshots.length();
+}
+
+//Step back to the previous snapshot and return it. Call only if can_undo()
+const Timeline_Snapshot &Timeline_History::undo()
+{
+    current_index--;
+    return snapshots.at(current_index);
+}
+
+//Step forward to the next snapshot and return it. Call only if can_redo()
+const Timeline_Snapshot &Timeline_History::redo()
+{
+    current_index++;
+    return snapshots.at(current_index);
+}
+
+const Timeline_Snapshot &Timeline_History::current() const
+{
+    return snapshots.at(current_index);
+}
+
+const Timeline_Snapshot &Timeline_History::at(int index) const
+{
+    return snapshots.at(index);
+}
+
+int Timeline_History::length() const
+{
+    return snapshots.length();
+}
+
+//Image of each slot of snapshot - its own image if it has one, else the original Frame from source_images
+QVector<QImage> Timeline_History::snapshot_images(const Timeline_Snapshot &snapshot, const QVector<QImage> &source_images)
+{
+    QVector<QImage>images(snapshot.timeline.length());
+    for (int i=0; i < images.length(); i++){
+        if (!snapshot.images.value(i).isNull())
+            images[i] = snapshot.images.at(i);
+        else
+            images[i] = source_images.value(snapshot.timeline.content_index.at(i));
+    }
+    return images;
+}
@@ -0,0 +1,66 @@
+#ifndef TIMELINE_HISTORY_H
+#define TIMELINE_HISTORY_H
+
+#include <QtGlobal>
+#include <QImage>
+#include <QString>
+#include <QVector>
+#include "retime_timeline.h"
+
+/*
+ * TIMELINE_HISTORY_DEPTH - deploys kept for undo. The oldest is dropped beyond this
+ */
+#define TIMELINE_HISTORY_DEPTH 32
+
+/*
+ * Timeline_Snapshot is one deploy - the timeline and the image of each slot that is not simply an original Frame
+ * (eg a motion blurred slot). Slots showing an original Frame hold a null image and are shown from the original
+ * Frames, so a snapshot never holds decoded pixels of its own. Snapshots are not modified once pushed, other than the
+ * current one's images when original Frames it blends are reloaded (see update_current).
+ */
+struct Timeline_Snapshot
+{
+    QString name;
+    Retime_Timeline timeline;
+    QVector<QImage> images;
+    qint64 accounted_bytes;
+};
+
+/*
+ * Timeline_History is the undo/redo history of deploys. Snapshots are implicitly shared copies - the timeline arrays
+ * and images are reference counted and copy-on-write - so pushing, undoing and redoing copy no pixels or arrays. Arrays
+ * equal to those of the previous snapshot share its storage.
+ *
+ * The images held only by the history (see Timeline_Snapshot) are accounted under MEMORY_RETIMED_FRAMES.
+ */
+class Timeline_History
+{
+public:
+    Timeline_History();
+    ~Timeline_History();
+
+    int current_index;
+
+    void push(const QString &name, const Retime_Timeline &timeline, const QVector<QImage> &images,
+              const QVector<QImage> &source_images);
+    void update_current(const QVector<QImage> &images, const QVector<QImage> &source_images);
+    void clear();
+    bool can_undo() const;
+    bool can_redo() const;
+    const Timeline_Snapshot &undo();
+    const Timeline_Snapshot &redo();
+    const Timeline_Snapshot &current() const;
+    const Timeline_Snapshot &at(int index) const;
+    int length() const;
+
+    static QVector<QImage> snapshot_images(const Timeline_Snapshot &snapshot, const QVector<QImage> &source_images);
+
+private:
+    QVector<Timeline_Snapshot>snapshots;
+
+    void drop(int index);
+    static void keep_images(Timeline_Snapshot *snapshot, const QVector<QImage> &images,
+                            const QVector<QImage> &source_images);
+};
+
+#endif // TIMELINE_HISTORY_H
@@ -0,0 +1,86 @@
+#include <QPainter>
+#include "variant_grid.h"
+#include "palette_storage.h"
+
+Variant_Grid::Variant_Grid(QList<Frame *> *source_frames, QWidget *parent)
+    : QWidget{parent}
+{
+    this->source_frames = source_frames;
+    this->position = 0;
+    setWindowTitle("Variants");
+    update_size();
+}
+
+void Variant_Grid::add_variant(const QString &name, const QVector<int> &content_map)
+{
+    variants.append({name, content_map});
+    update_size();
+    update();
+}
+
+void Variant_Grid::clear_variants()
+{
+    variants.clear();
+    update_size();
+    update();
+}
+
+//Show every variant at index position of the timeline
+void Variant_Grid::set_position(int position)
+{
+    if (this->position == position)
+        return;
+    this->position = position;
+    if (isVisible())
+        update();
+}
+
+//Size of one cell - the Frame scaled to VARIANT_CELL_WIDTH, with the variant name underneath
+QSize Variant_Grid::cell_size() const
+{
+    QSize frame_size(VARIANT_CELL_WIDTH, VARIANT_CELL_WIDTH * 3 / 4);
+    if (!source_frames->isEmpty() && !source_frames->first()->image->isNull())
+        frame_size = source_frames->first()->image->size().scaled(VARIANT_CELL_WIDTH, VARIANT_CELL_WIDTH * 4,
+                                                                   Qt::KeepAspectRatio);
+    return QSize(frame_size.width(), frame_size.height() + VARIANT_LABEL_HEIGHT);
+}
+
+void Variant_Grid::update_size()
+{
+    int columns = qBound(1, variants.length(), VARIANT_GRID_COLUMNS);
+    int rows = qMax(1, (variants.length() + VARIANT_GRID_COLUMNS - 1) / VARIANT_GRID_COLUMNS);
+    QSize cell = cell_size();
+    setFixedSize(columns * cell.width(), rows * cell.height());
+}
+
+//Draw each variant's Frame at this->position in its cell
+void Variant_Grid::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.fillRect(this->rect(), Qt::white);
+    painter.setPen(Qt::black);
+
+    QSize cell = cell_size();
+    for (int i=0; i < variants.length(); i++){
+        const Grid_Variant &variant = variants.at(i);
+        QRect cell_rect(QPoint((i % VARIANT_GRID_COLUMNS) * cell.width(), (i / VARIANT_GRID_COLUMNS) * cell.height()), cell);
+        QRect frame_rect = cell_rect.adjusted(0, 0, 0, -VARIANT_LABEL_HEIGHT);
+
+        //Slots beyond the content map show the original Frame at that index
+        int content_index = variant.content_map.value(position, position);
+        if (content_index >= 0 && content_index < source_frames->length()){
+            const QImage *image = source_frames->at(content_index)->image;
+            if (image->format() == QImage::Format_Indexed8){
+                static QImage display_buffer;
+                Palette_Storage::expand_for_display(*image, &display_buffer);
+                painter.drawImage(frame_rect, display_buffer);
+            } else
+                painter.drawImage(frame_rect, *image);
+        }
+
+        painter.drawRect(frame_rect.adjusted(0, 0, -1, -1));
+        painter.drawText(cell_rect.adjusted(4, frame_rect.height(), -4, 0), Qt::AlignLeft | Qt::AlignVCenter,
+                         QString("%1  [%2]").arg(variant.name).arg(content_index));
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef VARIANT_GRID_H
+#define VARIANT_GRID_H
+
+#include <QWidget>
+#include <QList>
+#include <QVector>
+#include "frame.h"
+
+#define VARIANT_GRID_COLUMNS 2
+#define VARIANT_CELL_WIDTH 320
+#define VARIANT_LABEL_HEIGHT 20
+
+/*
+ * Grid_Variant is one retiming shown in the Variant_Grid. It owns only its content map - the original Frame
+ * shown at each index of the timeline - never any image.
+ */
+struct Grid_Variant
+{
+    QString name;
+    QVector<int> content_map;
+};
+
+/*
+ * Variant_Grid is a separate window which plays several retimed variants (eg different Bezier Curves or keyframe
+ * timelines) side by side. Every variant draws straight from the one set of decoded original Frames (source_frames),
+ * so each variant added costs only its content map. All variants are shown at the same index of the timeline
+ * (see set_position), which MainWindow keeps in step with its slider.
+ */
+class Variant_Grid : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit Variant_Grid(QList<Frame *> *source_frames, QWidget *parent = nullptr);
+    QList<Frame *> *source_frames;
+    QVector<Grid_Variant>variants;
+    int position;
+
+    void add_variant(const QString &name, const QVector<int> &content_map);
+    void clear_variants();
+
+public slots:
+    void set_position(int position);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+
+private:
+    QSize cell_size() const;
+    void update_size();
+};
+
+#endif // VARIANT_GRID_H